@@ -85,6 +85,7 @@ App::start() {
 
   // We are now running the app
   status_ = App::Status::Running;
+  Trace::nameThread("Main");
 
   // Create a clock for measuring deltaTime
   sf::Clock clock_;
@@ -183,6 +184,7 @@ App::update(const sf::Time& dt) {
 
   // Easy out
   if (window_ == nullptr) return;
+  Trace::Scope trace("App::update", "app");
 
   // Update mouse position every frame
   sf::Vector2i mousePixelCoords = sf::Mouse::getPosition(*window_);
@@ -220,6 +222,7 @@ App::handleRenderThread() {
 
   // Easy out
   if (App::getStatus() < App::Status::Running) return;
+  Trace::nameThread("Render");
 
   // Continually render the app while
   while (App::getStatus() < App::Status::ShuttingDown) {
@@ -236,6 +239,7 @@ App::render() {
 
   // Easy out
   if (window_ == nullptr) return;
+  Trace::Scope trace("App::render", "app");
 
   // Clear the window for rendering
   window_->clear();
@@ -334,6 +338,9 @@ App::terminate() {
   // Set the app's status to break game loop
   status_ = App::Status::ShuttingDown;
 
+  // Write out any trace being recorded
+  Trace::stop();
+
   // Close the window, exiting the app loop
   if (window_ != nullptr) {
     window_->close();
@@ -427,6 +434,9 @@ App::handleImgui() {
     if (ImGui::BeginMenu("View")) {
       ImGui::MenuItem("Demo imgui", NULL, &showImguiDemo);
       ImGui::MenuItem("Console", NULL, &showConsole_);
+      if (ImGui::MenuItem("Record trace", NULL, Trace::isRecording())) {
+        Trace::toggle();
+      }
 
       // Allow the scene to make entries to the view tab
       if (currentScene_ != nullptr) {
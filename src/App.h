@@ -17,6 +17,7 @@
 
 #include "Resources.h"
 #include "Console.h"
+#include "Trace.h"
 
 // Forward declaration
 class Scene;
@@ -8,6 +8,7 @@
 
 // Avoid cyclic dependencies
 #include "App.h"
+#include "Trace.h"
 
 // Initialise static variables
 char Console::InputBuf[256];
@@ -29,6 +30,7 @@ Console::initialise(bool outputToTerminal) {
   addCommand("help");
   addCommand("clear");
   addCommand("history");
+  addCommand("trace");
   autoScroll_ = true;
   scrollToBottom_ = true;
 
@@ -243,6 +245,11 @@ Console::execCommand(const char* command_line) {
     }
   }
 
+  // Start or stop recording a trace with the TRACE command
+  else if (Stricmp(command_line, "TRACE") == 0) {
+    Trace::toggle();
+  }
+
   // Clear the log with the CLEAR command
   if (Stricmp(command_line, "CLEAR") == 0) {
     clear();
@@ -5,14 +5,26 @@
 #define CONTROLLER_ASTAR_H
 
 #include "../../Console.h"
+#include "../Common.h"
+#include "OpenList.h"
+#include "NodeArena.h"
+#include "ThreadPool.h"
+#include "SearchStats.h"
+#include "SearchLog.h"
+#include "StateCodec.h"
 
 #include <cassert>
+#include <climits>
 #include <unordered_map>
 #include <vector>
 #include <stack>
 #include <utility>
 #include <algorithm>
+#include <numeric>
 #include <functional>
+#include <chrono>
+#include <type_traits>
+#include <memory>
 
 // Seperate functions here from other controllers
 namespace Controller {
@@ -63,20 +75,128 @@ namespace Controller {
 //       return failure
 
   // A functor for using AStar
-  // Templates: thought STATE, ACTION, decision COST
-  template <class S, class A, class C>
+  // Costs must support +, and * by an unsigned int for weighted searches
+  // Templates: thought STATE, ACTION, decision COST, OPEN list policy,
+  // CODEC for what's stored of each state and action
+  template <class S, class A, class C,
+      template <class, class> class O = OpenList::QuaternaryHeap,
+      class Codec = IdentityCodec<S, A>>
   struct AStar {
 
   public:
 
+    // Storage used for discovered states
+    typedef NodeArena<
+        typename Codec::StateKey, typename Codec::ActionKey, C> Arena;
+
+    // Order of an open state, f first and then the tie-breaking policy
+    struct Priority {
+      C f;
+      C g;
+      unsigned long tie;
+    };
+
+    // Secondary key for breaking ties, lowest first
+    typedef std::function<unsigned long(const S&)> TieBreakKey;
+
     // Public getters
     const std::pair<A, C>& getCurrentAction() const { return currentAction; }
     const unsigned int& getStatesProcessed() const { return statesProcessed; }
-    const std::vector<S>& getRemaining() const { return remaining; }
-    const std::unordered_map<S, C>& getFScores() const { return fScore; }
-    const std::unordered_map<S, C>& getGScores() const { return gScore; }
+    const O<NodeId, Priority>& getRemaining() const { return remaining; }
+    std::size_t getOpenCount() const { 
+      return isFocal() ? focal.size() : remaining.size(); 
+    }
+    const Suboptimality& getSuboptimality() const { return suboptimality; }
+    TieBreak getTieBreak() const { return tieBreak; }
+    const Arena& getArena() const { return arena; }
+    const Codec& getCodec() const { return codec; }
+    std::size_t getClosedCount() const { return arena.getClosedCount(); }
+    unsigned long getGenerated() const { return stats.generated; }
+    unsigned long getLookups() const { return arena.getLookups(); }
+    unsigned long getProbes() const { return arena.getProbes(); }
+    const Budget& getBudget() const { return budget; }
+    bool getBudgetExhausted() const { return budgetExhausted; }
+    bool getStopped() const { return stopped; }
+
+    // Get the measurements taken by the current or last search
+    // Callables are only timed when asked to, otherwise their stats are 0
+    SearchStats getStats() const {
+      SearchStats result = stats;
+      result.getPossibleActions = getActionsTimer.get();
+      result.takeAction = takeActionTimer.get();
+      result.weighAction = weighActionTimer.get();
+      result.heuristic = heuristicTimer.get();
+      result.isStateEndpoint = isEndpointTimer.get();
+      return result;
+    }
+
+    // Limit the work done by future searches
+    void setBudget(const Budget& b) { budget = b; }
+
+    // Set the actions that finish a partial plan when the budget runs out
+    void setCompletion(const std::vector<A>& actions) { completion = actions; }
+
+    // Allow future searches to be abandoned from another thread
+    void setStopToken(const StopToken& token) { stopToken = token; }
+
+    // Trade plan cost for speed in future searches
+    // In weighted mode f values are scaled up by the weight's denominator,
+    // so the weight is kept in lowest terms to scale costs as little as
+    // possible
+    void setSuboptimality(const Suboptimality& s) { 
+      suboptimality = s; 
+      const unsigned int divisor = std::gcd(s.numerator, s.denominator);
+      if (divisor > 1) {
+        suboptimality.numerator /= divisor;
+        suboptimality.denominator /= divisor;
+      }
+    }
+
+    // Score the neighbours of each expanded state on this many threads
+    // Callables must be safe to call from several threads when above 1
+    void setSuccessorThreads(unsigned int n) {
+      if (n <= 1) { pool.reset(); }
+      else if (pool == nullptr || pool->size() != n) {
+        pool = std::make_unique<ThreadPool>(n);
+      }
+    }
+    unsigned int getSuccessorThreads() const { 
+      return pool != nullptr ? pool->size() : 1; 
+    }
+
+    // Choose how open states with the same f are ordered
+    // The focal list already orders by h, so it ignores this
+    void setTieBreak(TieBreak t) { tieBreak = t; }
+
+    // Set the key used by the user key policy
+    void setTieBreakKey(const TieBreakKey& key) { tieBreakKey = key; }
+
+    // Time every call future searches make to their callables
+    // Each call then costs two clock reads, so it's off by default
+    void setTimingCallbacks(bool enable) { isTimingCallbacks = enable; }
+    bool getTimingCallbacks() const { return isTimingCallbacks; }
+
+    // Append every state expanded by future searches to a log, or stop
+    // logging with nullptr
+    // Costs are logged as the score given, and h is kept for each state
+    // discovered while logging rather than worked out again
+    void setSearchLog(SearchLog<A>* log, 
+        const std::function<float(const C&)>& score) {
+      searchLog = log;
+      searchLogScore = score;
+    }
+
+    // Free all memory held from the last search
+    void release() {
+      arena.release();
+      remaining = O<NodeId, Priority>();
+      focal = OpenList::FocalList<NodeId, C>();
+      std::vector<Successor>().swap(successors);
+      std::vector<C>().swap(searchLogH);
+    }
 
     // Evaluates options and returns a stack of actions to take
+    // Kept for callers that already hold type-erased functions
     std::pair<bool, std::stack<A>> operator() (
         const S& startingState,
         const C& minimumCost,
@@ -87,170 +207,508 @@ namespace Controller {
         std::function<C(const S&, const S&, const S&, const A&)> weighAction,
         std::function<std::pair<bool, const S>(const S&, const A&)> takeAction,
         std::function<bool(const C&, const C&)> compareCost = std::less<C>()) {
+      return search(startingState, minimumCost, maximumCost,
+          getPossibleActions, isStateEndpoint, heuristic, weighAction,
+          takeAction, compareCost);
+    }
 
-      // All available states to explore
-      remaining = {startingState};
+    // Evaluates options and returns a stack of actions to take
+    // Callables are taken by type so the search can be inlined per caller
+    template <class GetActions, class IsEndpoint, class Heuristic,
+        class WeighAction, class TakeAction, class Compare = std::less<C>>
+    std::pair<bool, std::stack<A>> operator() (
+        const S& startingState,
+        const C& minimumCost,
+        const C& maximumCost,
+        const GetActions& getPossibleActions,
+        const IsEndpoint& isStateEndpoint,
+        const Heuristic& heuristic,
+        const WeighAction& weighAction,
+        const TakeAction& takeAction,
+        const Compare& compareCost = Compare()) {
+      return search(startingState, minimumCost, maximumCost,
+          getPossibleActions, isStateEndpoint, heuristic, weighAction,
+          takeAction, compareCost);
+    }
 
-      // Keep track of states already evaluated
-      std::vector<S> evaluated = {};
-      
-      // Map of which action led to which thought state
-      history.clear();
+  private:
+
+    // Run the search, timing every call made to the callables if asked to
+    template <class GetActions, class IsEndpoint, class Heuristic,
+        class WeighAction, class TakeAction, class Compare>
+    std::pair<bool, std::stack<A>> search(
+        const S& startingState,
+        const C& minimumCost,
+        const C& maximumCost,
+        const GetActions& getPossibleActions,
+        const IsEndpoint& isStateEndpoint,
+        const Heuristic& heuristic,
+        const WeighAction& weighAction,
+        const TakeAction& takeAction,
+        const Compare& compareCost) {
+
+      // Catch mismatched callables here rather than deep in the loop
+      static_assert(std::is_invocable_r_v<std::vector<A>, 
+          const GetActions&, const S&>,
+          "getPossibleActions must be callable as (S) -> vector<A>");
+      static_assert(std::is_invocable_r_v<bool, 
+          const IsEndpoint&, const S&, const S&>,
+          "isStateEndpoint must be callable as (S, S) -> bool");
+      static_assert(std::is_invocable_r_v<C, const Heuristic&, const S&>,
+          "heuristic must be callable as (S) -> C");
+      static_assert(std::is_invocable_r_v<C, 
+          const WeighAction&, const S&, const S&, const S&, const A&>,
+          "weighAction must be callable as (S, S, S, A) -> C");
+      static_assert(std::is_invocable_v<const TakeAction&, const S&, const A&>,
+          "takeAction must be callable as (S, A) -> pair<bool, S>");
+      static_assert(std::is_invocable_r_v<bool, 
+          const Compare&, const C&, const C&>,
+          "compareCost must be callable as (C, C) -> bool");
+
+      // Give up straight away on states the codec can't store
+      if (!codec.canEncode(startingState)) {
+        return std::make_pair(false, std::stack<A>());
+      }
+      codec.prepare(startingState);
+
+      // Measure this search from scratch
+      stats = SearchStats();
+      getActionsTimer.reset();
+      takeActionTimer.reset();
+      weighActionTimer.reset();
+      heuristicTimer.reset();
+      isEndpointTimer.reset();
+      const auto startTime = std::chrono::steady_clock::now();
+
+      // Search with every callable but the comparison wrapped in a timer,
+      // or with the callables as they are
+      const auto result = isTimingCallbacks
+          ? explore(startingState, minimumCost, maximumCost,
+              getActionsTimer.wrap(getPossibleActions),
+              isEndpointTimer.wrap(isStateEndpoint),
+              heuristicTimer.wrap(heuristic),
+              weighActionTimer.wrap(weighAction),
+              takeActionTimer.wrap(takeAction),
+              compareCost)
+          : explore(startingState, minimumCost, maximumCost,
+              getPossibleActions, isStateEndpoint, heuristic,
+              weighAction, takeAction, compareCost);
+
+      // Closed states are never reopened, so the count only ever grows
+      stats.peakClosed = arena.getClosedCount();
+      stats.lookups = arena.getLookups();
+      stats.hashCollisions = arena.getCollisions();
+      stats.approximateBytes = arena.getApproximateBytes()
+          + stats.peakOpen * (sizeof(NodeId) + sizeof(Priority));
+      stats.milliseconds = std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - startTime).count();
+      return result;
+    }
 
-      // How much decision power gained so far in each state
-      gScore = { { startingState, minimumCost } };
+    // Run the search itself with whatever callables were given
+    template <class GetActions, class IsEndpoint, class Heuristic,
+        class WeighAction, class TakeAction, class Compare>
+    std::pair<bool, std::stack<A>> explore(
+        const S& startingState,
+        const C& minimumCost,
+        const C& maximumCost,
+        const GetActions& getPossibleActions,
+        const IsEndpoint& isStateEndpoint,
+        const Heuristic& heuristic,
+        const WeighAction& weighAction,
+        const TakeAction& takeAction,
+        const Compare& compareCost) {
+
+      // Reuse memory from the last search to store discovered states
+      arena.clear();
+      remaining.clear();
+      pushes = 0;
+      focal.clear();
+      focal.setBound(suboptimality.numerator, suboptimality.denominator);
+
+      // The starting state is known with no cost to get to
+      const NodeId start = arena.insert(codec.encodeState(startingState)).first;
+      arena[start].g = minimumCost;
+      const C startH = heuristic(startingState);
+      arena[start].f = score(minimumCost, startH);
+      searchLogH.clear();
+      rememberH(start, startH);
 
-      // Map of predicted decision power from current state
-      fScore = { { startingState, heuristic(startingState) } };
+      // All available states to explore
+      openPush(start, arena[start].f, startH, compareCost);
 
       // Keep track of the number of actions processed
       statesProcessed = 0;
 
+      // When limited, remember the cheapest endpoint found so far
+      const bool isLimited = budget.isLimited();
+      const auto startTime = std::chrono::steady_clock::now();
+      NodeId bestEndpoint = invalidNode;
+      budgetExhausted = false;
+      stopped = false;
+
       // Keep processing until there are no states left to check
-      while (remaining.size() > 0) {
+      while (getOpenCount() > 0) {
+
+        // If asked to stop, abandon the search without a plan
+        if (stopToken.isStopRequested()) {
+          stopped = true;
+          return std::make_pair(false, std::stack<A>());
+        }
+
+        // If the budget has run out, settle for the best plan so far
+        if (isLimited && hasExceededBudget(startTime)) {
+          budgetExhausted = true;
+          return getBestPlan(start, bestEndpoint, 
+              startingState, isStateEndpoint, compareCost);
+        }
 
         // @ANALYSIS: Record how many moves have been processed
         statesProcessed += 1;
 
         // Get the highest priority state to operate on
-        auto current = std::min_element(remaining.begin(), remaining.end(),
-            [this, &maximumCost, &compareCost](const S& a, const S& b) {
-
-          // Find fScores of a and b
-          const C& fA = fScore.find(a) != fScore.end() ?
-              fScore[a] : maximumCost;
-          const C& fB = fScore.find(b) != fScore.end() ?
-              fScore[b] : maximumCost;
-
-          // Return whether fA should come before fB
-          return compareCost(fA, fB);
-        });
+        const NodeId current = openTop(compareCost);
+        const S& state = codec.decodeState(arena.getState(current));
+        const bool isEndpoint = isStateEndpoint(startingState, state);
+
+        // Record the expansion if asked to
+        if (searchLog != nullptr) {
+          const auto& node = arena[current];
+          searchLog->record(typename SearchLog<A>::Entry{current, 
+              node.parent, node.depth, codec.decodeAction(node.action), 
+              searchLogScore(node.g), searchLogScore(searchLogH[current]),
+              isEndpoint});
+        }
 
         // If we've arrived at a node that can be considered the goal, stop
-        const S state = *current;
-        if (isStateEndpoint(startingState, state)) {
+        if (isEndpoint) {
 
-          // Reconstruct the processes taken to get here
-          S pathNode = state;
+          // Build the path of actions from finish to start
           std::stack<A> actionsTaken;
+          const bool success = buildPath(start, current, actionsTaken);
+          return std::make_pair(success, actionsTaken);
+        }
 
-          // Build the path of actions from finish to start
-          while (pathNode != startingState) {
+        // No longer consider the current state
+        arena.close(current);
+        openPop(compareCost);
+
+        // Record a neighbour if this is the best way found to reach it
+        // Scores are fetched lazily as they may not be needed
+        const auto relax = [&](const A& action, const S& next,
+            const auto& getWeight, const auto& getHeuristic) {
+
+          // Find the neighbour, initialising it if it's new
+          const auto& found = arena.insert(codec.encodeState(next));
+          const NodeId neighbour = found.first;
+          stats.generated += 1;
+          if (found.second) {
+            arena[neighbour].g = maximumCost;
+          }
 
-            // Find how we got to the current state
-            const auto& it = history.find(pathNode);
-            if (it != history.end()) {
+          // Ignore neighbours that have already been evaluated
+          else {
+            stats.duplicates += 1;
+            if (arena[neighbour].closed) {
+              return;
+            }
+          }
 
-              // Get the data contained in the kvp
-              const auto& previous = it->second;
+          // Work out cost of taking this action with the current state
+          // The neighbour is equal to the stored state, so it's used as is
+          // rather than rebuilding it from its key
+          const S& future = next;
+          const C tentative_gScore = arena[current].g + getWeight(future);
 
-              // Focus on the previous state for next iteration
-              pathNode = previous.first;
+          // @ANALYSIS: Record what the action is
+          currentAction = std::make_pair(action, tentative_gScore);
 
-              // Add action to the stack
-              actionsTaken.push(previous.second);
+          // If our projected score is better than the one recorded
+          if (compareCost(tentative_gScore, arena[neighbour].g)) {
+
+            // Record how we got to this node and the improved scores
+            auto& node = arena[neighbour];
+            node.parent = current;
+            node.depth = arena[current].depth + 1;
+            node.action = codec.encodeAction(action);
+            node.g = tentative_gScore;
+            const C h = getHeuristic(future);
+            node.f = score(tentative_gScore, h);
+            rememberH(neighbour, h);
+
+            // Queue the neighbour to be evaluated, or reprioritise it
+            if (openContains(neighbour)) {
+              stats.reprioritised += 1;
+              openUpdate(neighbour, node.f, h, compareCost);
             }
-
-            // This shouldn't trigger as all routes should be traceable
-            // However, if it does, stop the infinite loop
             else {
-              assert(false);
-              return std::make_pair(false, actionsTaken);
+              openPush(neighbour, node.f, h, compareCost);
             }
-          }
-          return std::make_pair(true, actionsTaken);
-        }
 
-        // No longer consider the current state
-        evaluated.insert(evaluated.end(), state);
-        remaining.erase(current);
+            // Remember the cheapest endpoint in case the budget runs out
+            if (isLimited && isStateEndpoint(startingState, future)
+                && (bestEndpoint == invalidNode 
+                    || compareCost(node.g, arena[bestEndpoint].g))) {
+              bestEndpoint = neighbour;
+            }
+          }
+        };
 
-        // Initialise gScore of state if it's not there
-        if (gScore.find(state) == gScore.end()) {
-          gScore[state] = maximumCost;
-        }
-        
-        // Get possible (neighbour) states by trying all possible actions
+        // Try all possible actions to find neighbouring states
         const std::vector<A> actions = getPossibleActions(state);
-        std::vector<std::pair<S, A>> states;
-        std::for_each(actions.begin(), actions.end(),
-            [&states, &evaluated, &state, &takeAction] 
-                (const A& action) {
-
-          // Try taking the action with the current state
-          const auto& attempt = takeAction(state, action);
-
-          // Consider any valid states that haven't been evaluated
-          if (attempt.first 
-              && std::find(evaluated.begin(), evaluated.end(), attempt.second)
-                  == evaluated.end()) {
-            states.insert(states.end(), std::make_pair(attempt.second, action));
+        const unsigned long generatedBefore = stats.generated;
+
+        // With a pool, score every neighbour at once on its threads
+        // Results are merged in action order so the search stays the same
+        if (pool != nullptr && actions.size() > 1) {
+          successors.resize(actions.size());
+          pool->parallelFor(actions.size(), [&](std::size_t i) {
+            auto& successor = successors[i];
+            const auto& attempt = takeAction(state, actions[i]);
+            successor.isValid = attempt.first;
+            if (!attempt.first) { return; }
+            successor.state = attempt.second;
+            successor.weight = weighAction(
+                startingState, state, successor.state, actions[i]);
+            successor.h = heuristic(successor.state);
+          });
+          for (std::size_t i = 0; i < actions.size(); ++i) {
+            const Successor& successor = successors[i];
+            if (!successor.isValid) { continue; }
+            relax(actions[i], successor.state,
+                [&successor](const S&) { return successor.weight; },
+                [&successor](const S&) { return successor.h; });
           }
-        });
-
-        // For each neighbour
-        std::for_each(states.begin(), states.end(),
-            [this, &startingState, &state, 
-            &maximumCost, &weighAction, &heuristic, &compareCost] 
-                (const std::pair<S, A>& future) {
+        }
 
-          // Initialise gScore of neighbour if it's not there
-          if (gScore.find(future.first) == gScore.end()) {
-            gScore[future.first] = maximumCost;
+        // Otherwise try each action in turn, only scoring when necessary
+        else {
+          for (const A& action : actions) {
+            const auto& attempt = takeAction(state, action);
+            if (!attempt.first) { continue; }
+            relax(action, attempt.second,
+                [&](const S& future) {
+                  return weighAction(startingState, state, future, action);
+                },
+                [&](const S& future) { return heuristic(future); });
           }
+        }
 
-          // Work out cost of taking this action with the current state
-          const C tentative_gScore = gScore[state] + 
-              weighAction(startingState, state, future.first, future.second);
+        // Record how much the search branched out from this state
+        stats.expanded += 1;
+        const std::size_t branches = std::min<std::size_t>(
+            stats.generated - generatedBefore, stats.branching.size() - 1);
+        stats.branching[branches] += 1;
+        stats.peakOpen = std::max(stats.peakOpen, getOpenCount());
+      }
 
-          // @ANALYSIS: Record what the action is
-          currentAction = std::make_pair(future.second, tentative_gScore);
+      // Return unsuccessfully with the current state
+      return std::make_pair(false, std::stack<A>());
+    }
 
-          // If our projected score is better than the one recorded
-          if (compareCost(tentative_gScore, gScore[future.first])) {
+    // Check whether the focal list is in use instead of the open list
+    bool isFocal() const {
+      return suboptimality.mode == Suboptimality::Mode::Focal;
+    }
 
-            // Record how we got to this node (insert new state and the action)
-            history.insert(std::make_pair(
-                  future.first, 
-                  std::make_pair(state, future.second)));
+    // Combine g and h into f, weighting h if asked to
+    C score(const C& g, const C& h) const {
+      if (suboptimality.mode == Suboptimality::Mode::Weighted) {
+        return g * suboptimality.denominator + h * suboptimality.numerator;
+      }
+      return g + h;
+    }
 
-            // Update the gScore to the lower score
-            gScore[future.first] = tentative_gScore;
+    // Keep a node's h for the search log, if logging
+    void rememberH(NodeId id, const C& h) {
+      if (searchLog == nullptr) { return; }
+      if (id >= searchLogH.size()) { searchLogH.resize(id + 1, h); }
+      searchLogH[id] = h;
+    }
 
-            // Update fScore to a more accurate representation
-            fScore[future.first] = tentative_gScore + heuristic(future.first);
+    // Operations on whichever list is holding open states
+    template <class Compare>
+    void openPush(NodeId id, const C& f, const C& h, const Compare& compare) {
+      if (isFocal()) { focal.push(id, f, h, compare); }
+      else { remaining.push(id, prioritise(id, f), order(compare)); }
+    }
+    template <class Compare>
+    void openUpdate(NodeId id, const C& f, const C& h, 
+        const Compare& compare) {
+      if (isFocal()) { focal.update(id, f, h, compare); }
+      else { remaining.update(id, prioritise(id, f), order(compare)); }
+    }
+    template <class Compare>
+    NodeId openTop(const Compare& compare) {
+      return isFocal() ? focal.top(compare) : remaining.top(order(compare));
+    }
+    template <class Compare>
+    void openPop(const Compare& compare) {
+      if (isFocal()) { focal.pop(compare); }
+      else { remaining.pop(order(compare)); }
+    }
+    bool openContains(NodeId id) const {
+      return isFocal() ? focal.contains(id) : remaining.contains(id);
+    }
 
-            // If the current future isn't queued to be evaluated next, add it
-            if (std::find(remaining.begin(), remaining.end(), future.first) 
-                == remaining.end()) {
-              remaining.insert(remaining.end(), future.first);
-            }
+    // Work out where an open state sits among others with the same f
+    // Oldest first needs nothing, as open lists already prefer older keys
+    Priority prioritise(NodeId id, const C& f) {
+      unsigned long tie = 0;
+      switch (tieBreak) {
+        case TieBreak::Newest: tie = ULONG_MAX - pushes++; break;
+        case TieBreak::Deeper: tie = ULONG_MAX - arena[id].depth; break;
+        case TieBreak::UserKey:
+          if (tieBreakKey) { 
+            tie = tieBreakKey(codec.decodeState(arena.getState(id))); 
           }
-        });
+          break;
+        default: break;
       }
+      return Priority{f, arena[id].g, tie};
+    }
 
-      // Return unsuccessfully with the current state
-      return std::make_pair(false, std::stack<A>());
+    // Compare priorities by f, then by the tie-breaking policy
+    template <class Compare>
+    auto order(const Compare& compare) const {
+      return [this, &compare](const Priority& a, const Priority& b) {
+        if (compare(a.f, b.f)) { return true; }
+        if (compare(b.f, a.f)) { return false; }
+        if (tieBreak == TieBreak::HigherG) { return compare(b.g, a.g); }
+        return a.tie < b.tie;
+      };
     }
 
-  private:
+    // Check whether the search has used up its budget
+    bool hasExceededBudget(
+        const std::chrono::steady_clock::time_point& startTime) const {
+      if (budget.maxExpansions > 0 
+          && statesProcessed >= budget.maxExpansions) {
+        return true;
+      }
+      if (budget.maxNodes > 0 && arena.size() >= budget.maxNodes) {
+        return true;
+      }
+      if (budget.maxMilliseconds > 0) {
+        const auto elapsed = std::chrono::steady_clock::now() - startTime;
+        return elapsed >= std::chrono::milliseconds(budget.maxMilliseconds);
+      }
+      return false;
+    }
+
+    // Push the actions leading from start to node onto a stack
+    bool buildPath(NodeId start, NodeId node, std::stack<A>& actions) const {
+      while (node != start) {
+
+        // This shouldn't trigger as all routes should be traceable
+        // However, if it does, stop the infinite loop
+        if (node == invalidNode || actions.size() > arena.size()) {
+          assert(false);
+          return false;
+        }
+
+        // Add action to the stack and focus on the previous node
+        actions.push(codec.decodeAction(arena[node].action));
+        node = arena[node].parent;
+      }
+      return true;
+    }
+
+    // Get the best plan available when the search is cut short
+    // - The cheapest endpoint found, if any
+    // - Otherwise the next open state, finished with completion
+    template <class IsEndpoint, class Compare>
+    std::pair<bool, std::stack<A>> getBestPlan(
+        NodeId start,
+        NodeId bestEndpoint,
+        const S& startingState,
+        const IsEndpoint& isStateEndpoint,
+        const Compare& compareCost) {
+
+      // Use the cheapest endpoint if one was found
+      std::stack<A> actions;
+      if (bestEndpoint != invalidNode) {
+        const bool success = buildPath(start, bestEndpoint, actions);
+        return std::make_pair(success, actions);
+      }
+
+      // Otherwise use the open state that would have been expanded next
+      const NodeId frontier = openTop(compareCost);
+      if (!isStateEndpoint(startingState, 
+          codec.decodeState(arena.getState(frontier)))) {
+        for (auto it = completion.crbegin(); it != completion.crend(); ++it) {
+          actions.push(*it);
+        }
+      }
+      const bool success = buildPath(start, frontier, actions);
+      return std::make_pair(success, actions);
+    }
+
+    // Every state discovered and its search data
+    Arena arena;
+
+    // Converts states and actions to what's stored in the arena
+    Codec codec;
+
+    // Limits on the work done by a search
+    Budget budget;
+    bool budgetExhausted = false;
+
+    // Used to abandon a search early
+    StopToken stopToken;
+    bool stopped = false;
 
-    // All available states to explore
-    std::vector<S> remaining;
+    // A neighbour scored ahead of time by the thread pool
+    struct Successor {
+      bool isValid = false;
+      S state;
+      C weight;
+      C h;
+    };
 
-    // Store FScores (costs of finishing pathing of all states)
-    std::unordered_map<S, C> fScore;
+    // Threads for scoring neighbours, and space for their results
+    std::unique_ptr<ThreadPool> pool;
+    std::vector<Successor> successors;
 
-    // Accurate cost of getting to a state
-    std::unordered_map<S, C> gScore;
+    // Actions that finish a partial plan
+    std::vector<A> completion;
 
-    // Map of which action led to which thought state
-    // Map<future State, Pair<previous State, Action taken>>
-    std::unordered_map<S, std::pair<S, A>> history;
+    // Discovered states that still need exploring
+    O<NodeId, Priority> remaining;
+
+    // How ties between equal f values are broken
+    TieBreak tieBreak = TieBreak::Oldest;
+    TieBreakKey tieBreakKey;
+
+    // Number of pushes and updates, used to prefer the newest state
+    unsigned long pushes = 0;
+
+    // Where to record expanded states, if anywhere, and how to score costs
+    SearchLog<A>* searchLog = nullptr;
+    std::function<float(const C&)> searchLogScore;
+
+    // The h of every node discovered, only kept while logging
+    std::vector<C> searchLogH;
+
+    // How far the search may stray from the cheapest plan
+    Suboptimality suboptimality;
+
+    // Discovered states that still need exploring, when searching by focus
+    OpenList::FocalList<NodeId, C> focal;
 
     // Keep track of the number of actions processed
     unsigned int statesProcessed = 0;
 
+    // Measurements of the current or last search
+    // The callables are only timed when asked to
+    SearchStats stats;
+    bool isTimingCallbacks = false;
+    CallbackTimer getActionsTimer;
+    CallbackTimer takeActionTimer;
+    CallbackTimer weighActionTimer;
+    CallbackTimer heuristicTimer;
+    CallbackTimer isEndpointTimer;
+
     // Keep track of the current Action and its Cost
     std::pair<A, C> currentAction;
 
@@ -0,0 +1,283 @@
+// Controller/AStar/BeamSearch.h
+// A controller that employs beam search to decide in predictable time
+
+#ifndef CONTROLLER_BEAMSEARCH_H
+#define CONTROLLER_BEAMSEARCH_H
+
+#include "../Common.h"
+
+#include <vector>
+#include <stack>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <type_traits>
+
+// Seperate functions here from other controllers
+namespace Controller {
+
+  // Beam search
+  // - Searches one action deeper at a time, only keeping the best few
+  //   states at each depth, ranked by f = g + h
+  // - At most width states are expanded per depth, so the time taken
+  //   grows linearly with the length of a plan
+  // - Only the states at the current depth are held, along with the
+  //   action and parent of every state kept so plans can be rebuilt
+  // - States kept at any depth are never kept again, so moving back and
+  //   forth can't fill the beam and every search ends
+  // - Stops once the cheapest endpoint found can't be beaten by any state
+  //   kept, so plans may cost more than A*'s
+  // Takes the same callables as AStar
+  // Templates: thought STATE, ACTION, decision COST, HASH function
+  template <class S, class A, class C, class H = std::hash<S>>
+  class BeamSearch {
+
+    public:
+
+      // Public getters
+      unsigned int getWidth() const { return width; }
+      const unsigned int& getStatesProcessed() const { return statesProcessed; }
+      unsigned long getGenerated() const { return generated; }
+      std::size_t getOpenCount() const { return layer.size(); }
+      std::size_t getClosedCount() const { return trail.size(); }
+      unsigned long getLookups() const { return 0; }
+      unsigned long getProbes() const { return 0; }
+      bool getBudgetExhausted() const { return budgetExhausted; }
+      bool getStopped() const { return stopped; }
+
+      // Set how many states are kept at each depth
+      void setWidth(unsigned int w) { width = w > 0 ? w : 1; }
+
+      // Limit the work done by future searches
+      // The width already limits memory, so the node limit is ignored
+      void setBudget(const Budget& b) { budget = b; }
+
+      // Set the actions that finish a partial plan when the budget runs out
+      void setCompletion(const std::vector<A>& actions) { completion = actions; }
+
+      // Allow future searches to be abandoned from another thread
+      void setStopToken(const StopToken& token) { stopToken = token; }
+
+      // Free all memory held from the last search
+      void release() {
+        std::vector<Step>().swap(trail);
+        std::vector<Candidate>().swap(layer);
+        std::vector<Candidate>().swap(candidates);
+        std::unordered_set<S, H>().swap(kept);
+      }
+
+      // Evaluates options and returns a stack of actions to take
+      template <class GetActions, class IsEndpoint, class Heuristic,
+          class WeighAction, class TakeAction, class Compare = std::less<C>>
+      std::pair<bool, std::stack<A>> operator() (
+          const S& startingState,
+          const C& minimumCost,
+          const C& maximumCost,
+          const GetActions& getPossibleActions,
+          const IsEndpoint& isStateEndpoint,
+          const Heuristic& heuristic,
+          const WeighAction& weighAction,
+          const TakeAction& takeAction,
+          const Compare& compareCost = Compare()) {
+
+        // Prepare to search
+        release();
+        statesProcessed = 0;
+        generated = 0;
+        budgetExhausted = false;
+        stopped = false;
+        const auto startTime = std::chrono::steady_clock::now();
+
+        // There's nothing to do if we start at a goal
+        if (isStateEndpoint(startingState, startingState)) {
+          return std::make_pair(true, std::stack<A>());
+        }
+
+        // Start from the root
+        trail.push_back(Step{0, A()});
+        kept.insert(startingState);
+        const C rootF = minimumCost + heuristic(startingState);
+        layer.push_back(Candidate{startingState, minimumCost, rootF, 0, A()});
+
+        // The cheapest endpoint found so far
+        bool hasEndpoint = false;
+        Candidate endpoint{startingState, maximumCost, maximumCost, 0, A()};
+
+        // Order candidates by f, earliest generated first when tied
+        std::vector<std::size_t> order;
+        const auto isBetter = [&](std::size_t a, std::size_t b) {
+          if (compareCost(candidates[a].f, candidates[b].f)) { return true; }
+          if (compareCost(candidates[b].f, candidates[a].f)) { return false; }
+          return a < b;
+        };
+
+        // Search one depth at a time
+        while (!layer.empty()) {
+
+          // Expand every state kept at this depth
+          candidates.clear();
+          std::unordered_map<S, std::size_t, H> candidateIndex;
+          for (const Candidate& current : layer) {
+
+            // Give up if asked to
+            if (stopToken.isStopRequested()) {
+              stopped = true;
+              return std::make_pair(false, std::stack<A>());
+            }
+
+            // If the budget has run out, settle for the best so far
+            if (budget.isLimited() && hasExceededBudget(startTime)) {
+              budgetExhausted = true;
+              return hasEndpoint
+                  ? std::make_pair(true, buildPlan(endpoint, false))
+                  : std::make_pair(true, buildPlan(layer.front(), true));
+            }
+
+            // @ANALYSIS: Record how many moves have been processed
+            statesProcessed += 1;
+
+            for (const A& action : getPossibleActions(current.state)) {
+              const auto& attempt = takeAction(current.state, action);
+              if (!attempt.first) { continue; }
+              generated += 1;
+              const S& future = attempt.second;
+              const C g = current.g +
+                  weighAction(startingState, current.state, future, action);
+              const C f = g + heuristic(future);
+
+              // Remember the cheapest endpoint rather than searching on
+              if (isStateEndpoint(startingState, future)) {
+                if (!hasEndpoint || compareCost(f, endpoint.f)) {
+                  endpoint = Candidate{future, g, f, current.parent, action};
+                  hasEndpoint = true;
+                }
+                continue;
+              }
+
+              // Don't return to states kept at an earlier depth
+              if (kept.find(future) != kept.end()) { continue; }
+
+              // Keep only the cheapest way to each state at this depth
+              const auto known = candidateIndex.find(future);
+              if (known != candidateIndex.end()) {
+                Candidate& other = candidates[known->second];
+                if (compareCost(g, other.g)) {
+                  other = Candidate{future, g, f, current.parent, action};
+                }
+                continue;
+              }
+              candidateIndex.emplace(future, candidates.size());
+              candidates.push_back(
+                  Candidate{future, g, f, current.parent, action});
+            }
+          }
+
+          // Keep the best few to search from next
+          order.resize(candidates.size());
+          for (std::size_t i = 0; i < order.size(); ++i) { order[i] = i; }
+          const std::size_t best = std::min<std::size_t>(width, order.size());
+          std::partial_sort(
+              order.begin(), order.begin() + best, order.end(), isBetter);
+          layer.clear();
+          for (std::size_t i = 0; i < best; ++i) {
+            Candidate& chosen = candidates[order[i]];
+            trail.push_back(Step{chosen.parent, chosen.action});
+            chosen.parent = trail.size() - 1;
+            kept.insert(chosen.state);
+            layer.push_back(std::move(chosen));
+          }
+
+          // Stop once nothing kept could lead to a cheaper endpoint
+          if (hasEndpoint && (layer.empty()
+              || !compareCost(layer.front().f, endpoint.f))) {
+            return std::make_pair(true, buildPlan(endpoint, false));
+          }
+        }
+
+        // Every state was a dead end
+        return std::make_pair(false, std::stack<A>());
+      }
+
+    private:
+
+      // How a kept state was reached
+      struct Step {
+        std::size_t parent;
+        A action;
+      };
+
+      // A state generated at the current depth
+      // Parent is the step it came from, until it's kept and becomes its own
+      struct Candidate {
+        S state;
+        C g;
+        C f;
+        std::size_t parent;
+        A action;
+      };
+
+      // Number of states kept per depth
+      unsigned int width = 16;
+
+      // Every state kept so far, and the states at the current depth
+      std::vector<Step> trail;
+      std::vector<Candidate> layer;
+      std::vector<Candidate> candidates;
+
+      // Every state kept so far, to avoid searching from them again
+      std::unordered_set<S, H> kept;
+
+      // Limits on the work done by a search
+      Budget budget;
+      bool budgetExhausted = false;
+
+      // Actions that finish a partial plan
+      std::vector<A> completion;
+
+      // Used to abandon a search early
+      StopToken stopToken;
+      bool stopped = false;
+
+      // Keep track of the work done
+      unsigned int statesProcessed = 0;
+      unsigned long generated = 0;
+
+      // Check whether the search has used up its budget
+      bool hasExceededBudget(
+          const std::chrono::steady_clock::time_point& startTime) const {
+        if (budget.maxExpansions > 0
+            && statesProcessed >= budget.maxExpansions) {
+          return true;
+        }
+        if (budget.maxMilliseconds > 0) {
+          const auto elapsed = std::chrono::steady_clock::now() - startTime;
+          return elapsed >= std::chrono::milliseconds(budget.maxMilliseconds);
+        }
+        return false;
+      }
+
+      // Turn the steps leading to a state into a stack of actions
+      // Kept states are their own step, endpoints are one step further on
+      std::stack<A> buildPlan(const Candidate& last, bool isKept) const {
+        std::stack<A> actions;
+        if (isKept) {
+          for (auto it = completion.crbegin(); it != completion.crend(); ++it) {
+            actions.push(*it);
+          }
+        }
+        else {
+          actions.push(last.action);
+        }
+        for (std::size_t step = last.parent; step != 0;
+            step = trail[step].parent) {
+          actions.push(trail[step].action);
+        }
+        return actions;
+      }
+  };
+}
+
+#endif
@@ -0,0 +1,273 @@
+// Controller/AStar/IDAStar.h
+// A controller that employs Iterative Deepening A* to save memory
+
+#ifndef CONTROLLER_IDASTAR_H
+#define CONTROLLER_IDASTAR_H
+
+#include "../Common.h"
+
+#include <vector>
+#include <stack>
+#include <unordered_map>
+#include <utility>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <type_traits>
+
+// Seperate functions here from other controllers
+namespace Controller {
+
+  // Iterative Deepening A* (IDA*)
+  // - Repeated depth-first searches that ignore states whose f is above a
+  //   threshold, raising the threshold to the lowest f ignored each time
+  // - Only the current path is held in memory, so memory use is linear in
+  //   the length of a plan, at the cost of re-expanding states
+  // - States already on the current path are skipped to avoid cycles
+  // - Each pass remembers the cheapest cost each state was reached for, in
+  //   a table of fixed size, and skips states reached again for no less, as
+  //   everything below them has already been seen
+  // - The table holds at most 65536 states unless told otherwise, or the
+  //   node limit if that's lower, so memory stays bounded by default
+  // Takes the same callables as AStar
+  // Templates: thought STATE, ACTION, decision COST, HASH function
+  template <class S, class A, class C, class H = std::hash<S>>
+  class IDAStar {
+
+    public:
+
+      // Public getters
+      const unsigned int& getStatesProcessed() const { return statesProcessed; }
+      unsigned long getGenerated() const { return generated; }
+      unsigned int getIterations() const { return iterations; }
+      std::size_t getOpenCount() const { return path.size(); }
+      std::size_t getClosedCount() const { return seen.size(); }
+      unsigned long getLookups() const { return 0; }
+      unsigned long getProbes() const { return 0; }
+      bool getBudgetExhausted() const { return budgetExhausted; }
+      bool getStopped() const { return stopped; }
+
+      // Limit the work done by future searches
+      // The node limit caps the size of the table instead of ending the search
+      void setBudget(const Budget& b) { budget = b; }
+
+      // Set the most states the table may hold, whatever the node limit
+      void setTableLimit(std::size_t n) { tableLimit = n; }
+      std::size_t getTableLimit() const { return tableLimit; }
+
+      // Set the actions that finish a partial plan when the budget runs out
+      void setCompletion(const std::vector<A>& actions) { completion = actions; }
+
+      // Allow future searches to be abandoned from another thread
+      void setStopToken(const StopToken& token) { stopToken = token; }
+
+      // Free all memory held from the last search
+      void release() {
+        std::vector<Frame>().swap(path);
+        std::unordered_map<S, C, H>().swap(seen);
+      }
+
+      // Evaluates options and returns a stack of actions to take
+      template <class GetActions, class IsEndpoint, class Heuristic,
+          class WeighAction, class TakeAction, class Compare = std::less<C>>
+      std::pair<bool, std::stack<A>> operator() (
+          const S& startingState,
+          const C& minimumCost,
+          const C& maximumCost,
+          const GetActions& getPossibleActions,
+          const IsEndpoint& isStateEndpoint,
+          const Heuristic& heuristic,
+          const WeighAction& weighAction,
+          const TakeAction& takeAction,
+          const Compare& compareCost = Compare()) {
+
+        // Prepare to search
+        statesProcessed = 0;
+        generated = 0;
+        iterations = 0;
+        budgetExhausted = false;
+        stopped = false;
+        const auto startTime = std::chrono::steady_clock::now();
+
+        // Start by only allowing states as promising as the start
+        C threshold = minimumCost + heuristic(startingState);
+
+        // The table is never bigger than its own limit or the node limit
+        const std::size_t limit = budget.maxNodes > 0
+            ? std::min<std::size_t>(budget.maxNodes, tableLimit)
+            : tableLimit;
+
+        // Deepen until a plan is found or no states are left
+        while (true) {
+          iterations += 1;
+
+          // The lowest f that was too high to explore this time
+          bool hasNext = false;
+          C next = maximumCost;
+
+          // Depth-first search from the start
+          path.clear();
+          seen.clear();
+          path.push_back(Frame{startingState, minimumCost, threshold, A(), {}});
+          while (!path.empty()) {
+
+            // Give up if asked to
+            if (stopToken.isStopRequested()) {
+              stopped = true;
+              path.clear();
+              return std::make_pair(false, std::stack<A>());
+            }
+
+            // If the budget has run out, settle for the current path
+            if (budget.isLimited() && hasExceededBudget(startTime)) {
+              budgetExhausted = true;
+              return getCurrentPlan(startingState, isStateEndpoint);
+            }
+
+            Frame& frame = path.back();
+
+            // When first visiting a state, check it against the threshold
+            if (!frame.isExpanded) {
+              if (compareCost(threshold, frame.f)) {
+                if (!hasNext || compareCost(frame.f, next)) {
+                  next = frame.f;
+                  hasNext = true;
+                }
+                path.pop_back();
+                continue;
+              }
+
+              // If we've arrived at a goal, the path is the plan
+              if (isStateEndpoint(startingState, frame.state)) {
+                return std::make_pair(true, buildPlan());
+              }
+
+              // @ANALYSIS: Record how many moves have been processed
+              statesProcessed += 1;
+              frame.actions = getPossibleActions(frame.state);
+              frame.isExpanded = true;
+            }
+
+            // Backtrack once every action has been tried
+            if (frame.next >= frame.actions.size()) {
+              path.pop_back();
+              continue;
+            }
+
+            // Try the next action, skipping states already on the path
+            const A action = frame.actions[frame.next++];
+            const auto& attempt = takeAction(frame.state, action);
+            if (!attempt.first) { continue; }
+            generated += 1;
+            const S& future = attempt.second;
+            if (std::any_of(path.begin(), path.end(),
+                [&future](const Frame& f) { return f.state == future; })) {
+              continue;
+            }
+
+            // Skip states already reached this pass for no more cost
+            const C g = frame.g +
+                weighAction(startingState, frame.state, future, action);
+            const auto known = seen.find(future);
+            if (known != seen.end()) {
+              if (!compareCost(g, known->second)) { continue; }
+              known->second = g;
+            }
+            else if (seen.size() < limit) {
+              seen.emplace(future, g);
+            }
+
+            // Step into the neighbour
+            const C f = g + heuristic(future);
+            path.push_back(Frame{future, g, f, action, {}});
+          }
+
+          // If nothing was cut off there's nowhere left to look
+          if (!hasNext) {
+            return std::make_pair(false, std::stack<A>());
+          }
+          threshold = next;
+        }
+      }
+
+    private:
+
+      // A state on the current path and the actions left to try from it
+      struct Frame {
+        S state;
+        C g;
+        C f;
+        A action;
+        std::vector<A> actions;
+        std::size_t next = 0;
+        bool isExpanded = false;
+      };
+
+      // The path currently being explored
+      std::vector<Frame> path;
+
+      // The cheapest cost each state has been reached for this pass, and
+      // the most states it may hold
+      std::unordered_map<S, C, H> seen;
+      std::size_t tableLimit = 1 << 16;
+
+      // Limits on the work done by a search
+      Budget budget;
+      bool budgetExhausted = false;
+
+      // Actions that finish a partial plan
+      std::vector<A> completion;
+
+      // Used to abandon a search early
+      StopToken stopToken;
+      bool stopped = false;
+
+      // Keep track of the work done
+      unsigned int statesProcessed = 0;
+      unsigned long generated = 0;
+      unsigned int iterations = 0;
+
+      // Check whether the search has used up its budget
+      // The node limit is handled by the size of the table instead
+      bool hasExceededBudget(
+          const std::chrono::steady_clock::time_point& startTime) const {
+        if (budget.maxExpansions > 0
+            && statesProcessed >= budget.maxExpansions) {
+          return true;
+        }
+        if (budget.maxMilliseconds > 0) {
+          const auto elapsed = std::chrono::steady_clock::now() - startTime;
+          return elapsed >= std::chrono::milliseconds(budget.maxMilliseconds);
+        }
+        return false;
+      }
+
+      // Turn the current path into a stack of actions
+      std::stack<A> buildPlan() const {
+        std::stack<A> actions;
+        for (std::size_t i = path.size(); i > 1; --i) {
+          actions.push(path[i - 1].action);
+        }
+        return actions;
+      }
+
+      // Get the current path, finished with completion if necessary
+      template <class IsEndpoint>
+      std::pair<bool, std::stack<A>> getCurrentPlan(
+          const S& startingState,
+          const IsEndpoint& isStateEndpoint) const {
+        std::stack<A> actions;
+        if (!isStateEndpoint(startingState, path.back().state)) {
+          for (auto it = completion.crbegin(); it != completion.crend(); ++it) {
+            actions.push(*it);
+          }
+        }
+        for (std::size_t i = path.size(); i > 1; --i) {
+          actions.push(path[i - 1].action);
+        }
+        return std::make_pair(true, actions);
+      }
+  };
+}
+
+#endif
@@ -0,0 +1,226 @@
+// Controller/AStar/NodeArena.h
+// Storage for every state discovered during an A* search
+
+#ifndef CONTROLLER_ASTAR_NODEARENA_H
+#define CONTROLLER_ASTAR_NODEARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+// Seperate functions here from other controllers
+namespace Controller {
+
+  // Nodes are referred to by their position in the arena
+  typedef std::uint32_t NodeId;
+
+  // Marker for a node that doesn't exist (such as the parent of the start)
+  constexpr NodeId invalidNode = static_cast<NodeId>(-1);
+
+  // Stores each unique state once and gives it a NodeId
+  // - Search data (scores, parent, action) lives in a compact 'hot' array
+  // - Full states live in a separate 'cold' store that is rarely touched
+  // - An open-addressing table maps states to ids, comparing full hashes
+  //   first and only falling back to operator== when they match
+  // Templates: thought STATE, ACTION, decision COST, HASH function
+  template <class S, class A, class C, class H = std::hash<S>>
+  class NodeArena {
+
+    public:
+
+      // Search data for a discovered state
+      struct Node {
+
+        // Cost of the cheapest known path to this node
+        C g;
+
+        // Predicted cost of a path to a goal through this node
+        C f;
+
+        // The node this one was reached from, and how
+        NodeId parent = invalidNode;
+        A action = A();
+
+        // Number of actions taken to reach this node
+        unsigned int depth = 0;
+
+        // Whether this node has been expanded
+        bool closed = false;
+      };
+
+      // Forget all nodes but keep memory around for the next search
+      void clear() {
+        nodes_.clear();
+        states_.clear();
+        std::fill(slots_.begin(), slots_.end(), Slot());
+        closed_ = 0;
+        lookups_ = 0;
+        probes_ = 0;
+        collisions_ = 0;
+      }
+
+      // Forget all nodes and give memory back
+      void release() {
+        clear();
+        std::vector<Node>().swap(nodes_);
+        std::deque<S>().swap(states_);
+        std::vector<Slot>().swap(slots_);
+      }
+
+      // Number of nodes in the arena
+      std::size_t size() const { return nodes_.size(); }
+
+      // Find a state's node, creating it if necessary
+      // Returns the id and whether the node is new
+      std::pair<NodeId, bool> insert(const S& state) {
+
+        // Keep the load factor at or below one half
+        if ((nodes_.size() + 1) * 2 > slots_.size()) {
+          grow();
+        }
+
+        // Find the state or the empty slot where it belongs
+        const std::size_t hash = hasher_(state);
+        Slot& slot = slots_[find(state, hash)];
+        if (slot.id != invalidNode) {
+          return std::make_pair(slot.id, false);
+        }
+
+        // Store the state and point the slot at it
+        const NodeId id = static_cast<NodeId>(nodes_.size());
+        slot.hash = hash;
+        slot.id = id;
+        nodes_.emplace_back();
+        states_.push_back(state);
+        return std::make_pair(id, true);
+      }
+
+      // Find a state's node without creating it
+      NodeId find(const S& state) {
+        if (slots_.empty()) { return invalidNode; }
+        return slots_[find(state, hasher_(state))].id;
+      }
+
+      // Access the search data of a node
+      Node& operator[](NodeId id) { return nodes_[id]; }
+      const Node& operator[](NodeId id) const { return nodes_[id]; }
+
+      // Access the state of a node
+      // References stay valid until the arena is cleared
+      const S& getState(NodeId id) const { return states_[id]; }
+
+      // Access all nodes
+      const std::vector<Node>& getNodes() const { return nodes_; }
+
+      // Mark a node as expanded
+      void close(NodeId id) {
+        if (!nodes_[id].closed) {
+          nodes_[id].closed = true;
+          closed_ += 1;
+        }
+      }
+
+      // Allow a closed node to be expanded again
+      void reopen(NodeId id) {
+        if (nodes_[id].closed) {
+          nodes_[id].closed = false;
+          closed_ -= 1;
+        }
+      }
+
+      // Number of nodes that have been expanded
+      std::size_t getClosedCount() const { return closed_; }
+
+      // Number of times the table has been searched
+      unsigned long getLookups() const { return lookups_; }
+
+      // Number of slots inspected across all searches
+      unsigned long getProbes() const { return probes_; }
+
+      // Number of slots whose full hash matched a different state
+      unsigned long getCollisions() const { return collisions_; }
+
+      // Rough memory held, not counting heap memory owned by states
+      std::size_t getApproximateBytes() const {
+        return nodes_.capacity() * sizeof(Node)
+            + states_.size() * sizeof(S)
+            + slots_.capacity() * sizeof(Slot);
+      }
+
+    private:
+
+      // A slot in the table
+      struct Slot {
+        std::size_t hash = 0;
+        NodeId id = invalidNode;
+      };
+
+      // Hot search data, indexed by NodeId
+      std::vector<Node> nodes_;
+
+      // Cold full states, indexed by NodeId
+      // A deque never moves existing elements, so references stay valid
+      std::deque<S> states_;
+
+      // Table of slots, always a power of two in size
+      std::vector<Slot> slots_;
+
+      // Hash function for states
+      H hasher_;
+
+      // Number of closed nodes
+      std::size_t closed_ = 0;
+
+      // @ANALYSIS: Record how much work lookups are doing
+      unsigned long lookups_ = 0;
+      unsigned long probes_ = 0;
+      unsigned long collisions_ = 0;
+
+      // Linear probe for a state, returning its slot or the first empty one
+      std::size_t find(const S& state, std::size_t hash) {
+        lookups_ += 1;
+        const std::size_t mask = slots_.size() - 1;
+        std::size_t i = mix(hash) & mask;
+        while (true) {
+          probes_ += 1;
+          const Slot& slot = slots_[i];
+          if (slot.id == invalidNode) { return i; }
+          if (slot.hash == hash) {
+            if (states_[slot.id] == state) { return i; }
+            collisions_ += 1;
+          }
+          i = (i + 1) & mask;
+        }
+      }
+
+      // Double the size of the table and re-insert every node
+      void grow() {
+        const std::size_t size = slots_.empty() ? 64 : slots_.size() * 2;
+        std::vector<Slot> old;
+        old.swap(slots_);
+        slots_.assign(size, Slot());
+        const std::size_t mask = size - 1;
+        for (const Slot& s : old) {
+          if (s.id == invalidNode) { continue; }
+          std::size_t i = mix(s.hash) & mask;
+          while (slots_[i].id != invalidNode) { i = (i + 1) & mask; }
+          slots_[i] = s;
+        }
+      }
+
+      // Spread weak hashes across the table (splitmix64 finaliser)
+      static std::size_t mix(std::size_t h) {
+        unsigned long long x = h;
+        x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return static_cast<std::size_t>(x);
+      }
+  };
+}
+
+#endif
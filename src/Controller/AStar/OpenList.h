@@ -0,0 +1,447 @@
+// Controller/AStar/OpenList.h
+// Policies for storing the states A* has discovered but not yet expanded
+
+#ifndef CONTROLLER_ASTAR_OPENLIST_H
+#define CONTROLLER_ASTAR_OPENLIST_H
+
+#include <cassert>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <numeric>
+#include <type_traits>
+
+// Seperate open lists from other controllers
+namespace Controller::OpenList {
+
+  // All open lists share the same interface:
+  // - push(key, f, compare) inserts a key that isn't already open
+  // - update(key, f, compare) changes the f value of an open key
+  // - top(compare) returns the key with the lowest f
+  // - pop(compare) removes the key returned by top
+  // Ties between equal f values are broken by insertion order, so the oldest
+  // key is expanded first, and updating a key does not change its age
+
+  // The original behaviour, an unsorted vector that is scanned every time
+  // Templates: KEY, COST
+  template <class K, class C>
+  class VectorScan {
+
+    public:
+
+      // Remove all entries
+      void clear() { entries_.clear(); best_ = npos; }
+
+      // Query the size of the list
+      bool empty() const { return entries_.empty(); }
+      std::size_t size() const { return entries_.size(); }
+
+      // Check whether a key is in the list
+      bool contains(const K& key) const { return find(key) != npos; }
+
+      // Add a key to the end of the list
+      template <class Compare>
+      void push(const K& key, const C& f, const Compare&) {
+        entries_.push_back(std::make_pair(key, f));
+        best_ = npos;
+      }
+
+      // Change the f value of an open key
+      template <class Compare>
+      void update(const K& key, const C& f, const Compare&) {
+        const std::size_t i = find(key);
+        assert(i != npos);
+        entries_[i].second = f;
+        best_ = npos;
+      }
+
+      // Scan the list for the lowest f, preferring earlier entries
+      template <class Compare>
+      const K& top(const Compare& compare) {
+        assert(!entries_.empty());
+        best_ = 0;
+        for (std::size_t i = 1; i < entries_.size(); ++i) {
+          if (compare(entries_[i].second, entries_[best_].second)) {
+            best_ = i;
+          }
+        }
+        return entries_[best_].first;
+      }
+
+      // Remove the entry found by the last call to top
+      template <class Compare>
+      void pop(const Compare& compare) {
+        if (best_ == npos) { top(compare); }
+        entries_.erase(entries_.begin() + best_);
+        best_ = npos;
+      }
+
+    private:
+
+      // Marker for an invalid index
+      static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+      // Keys and their f values in insertion order
+      std::vector<std::pair<K, C>> entries_;
+
+      // Index of the entry found by top, if still valid
+      std::size_t best_ = npos;
+
+      // Linear search for a key
+      std::size_t find(const K& key) const {
+        const auto it = std::find_if(entries_.begin(), entries_.end(),
+            [&key](const std::pair<K, C>& e) { return e.first == key; });
+        return it != entries_.end() ? it - entries_.begin() : npos;
+      }
+  };
+
+  // Tracks where each key sits in a heap
+  // Any hashable key is stored in a map
+  template <class K, class Enable = void>
+  class PositionIndex {
+    public:
+      void clear() { positions_.clear(); }
+      bool contains(const K& key) const {
+        return positions_.find(key) != positions_.end();
+      }
+      std::size_t get(const K& key) const { return positions_.at(key); }
+      void set(const K& key, std::size_t i) { positions_[key] = i; }
+      void erase(const K& key) { positions_.erase(key); }
+    private:
+      std::unordered_map<K, std::size_t> positions_;
+  };
+
+  // Dense unsigned keys, such as node ids, index straight into a vector
+  template <class K>
+  class PositionIndex<K, std::enable_if_t<std::is_unsigned<K>::value>> {
+    public:
+      void clear() { positions_.clear(); }
+      bool contains(const K& key) const {
+        return key < positions_.size() && positions_[key] != npos;
+      }
+      std::size_t get(const K& key) const { return positions_[key]; }
+      void set(const K& key, std::size_t i) {
+        if (key >= positions_.size()) { positions_.resize(key + 1, npos); }
+        positions_[key] = i;
+      }
+      void erase(const K& key) { positions_[key] = npos; }
+    private:
+      static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+      std::vector<std::size_t> positions_;
+  };
+
+  // An indexed d-ary min-heap
+  // The position of every key is tracked so membership tests are O(1) and
+  // the f value of an open key can be changed in O(log n)
+  // Templates: KEY, COST, number of children per node
+  template <class K, class C, unsigned int D = 4>
+  class IndexedHeap {
+
+    static_assert(D >= 2, "A heap needs at least two children per node");
+
+    public:
+
+      // Remove all entries
+      void clear() { heap_.clear(); index_.clear(); age_ = 0; }
+
+      // Query the size of the heap
+      bool empty() const { return heap_.empty(); }
+      std::size_t size() const { return heap_.size(); }
+
+      // Check whether a key is in the heap
+      bool contains(const K& key) const { return index_.contains(key); }
+
+      // Insert a key that isn't already open
+      template <class Compare>
+      void push(const K& key, const C& f, const Compare& compare) {
+        push(key, f, age_, compare);
+      }
+
+      // Insert a key with a given age, so a key moved between heaps keeps
+      // its place among keys with the same f
+      template <class Compare>
+      void push(const K& key, const C& f, unsigned long age, 
+          const Compare& compare) {
+        assert(!contains(key));
+        const std::size_t i = heap_.size();
+        heap_.push_back(Entry{key, f, age});
+        age_ = std::max(age_, age + 1);
+        index_.set(key, i);
+        siftUp(i, compare);
+      }
+
+      // Change the f value of an open key, keeping its age
+      template <class Compare>
+      void update(const K& key, const C& f, const Compare& compare) {
+        assert(contains(key));
+        const std::size_t i = index_.get(key);
+        heap_[i].f = f;
+        siftDown(siftUp(i, compare), compare);
+      }
+
+      // Retrieve the key with the lowest f
+      template <class Compare>
+      const K& top(const Compare&) const {
+        assert(!heap_.empty());
+        return heap_.front().key;
+      }
+
+      // Retrieve the f value of an open key
+      const C& priority(const K& key) const {
+        assert(contains(key));
+        return heap_[index_.get(key)].f;
+      }
+
+      // Retrieve when an open key was first pushed
+      unsigned long age(const K& key) const {
+        assert(contains(key));
+        return heap_[index_.get(key)].age;
+      }
+
+      // Remove the key with the lowest f
+      template <class Compare>
+      void pop(const Compare& compare) {
+        assert(!heap_.empty());
+        erase(heap_.front().key, compare);
+      }
+
+      // Remove any open key
+      template <class Compare>
+      void erase(const K& key, const Compare& compare) {
+        assert(contains(key));
+        const std::size_t i = index_.get(key);
+        index_.erase(key);
+        if (i + 1 < heap_.size()) {
+          heap_[i] = std::move(heap_.back());
+          heap_.pop_back();
+          index_.set(heap_[i].key, i);
+          siftDown(siftUp(i, compare), compare);
+        }
+        else {
+          heap_.pop_back();
+        }
+      }
+
+    private:
+
+      // A key, its f value and when it was first pushed
+      struct Entry {
+        K key;
+        C f;
+        unsigned long age;
+      };
+
+      // Entries laid out as an implicit d-ary tree
+      std::vector<Entry> heap_;
+
+      // Position of every key in the heap
+      PositionIndex<K> index_;
+
+      // Counter used to order entries with equal f values
+      unsigned long age_ = 0;
+
+      // Whether entry a should be expanded before entry b
+      template <class Compare>
+      static bool before(const Entry& a, const Entry& b,
+          const Compare& compare) {
+        if (compare(a.f, b.f)) { return true; }
+        if (compare(b.f, a.f)) { return false; }
+        return a.age < b.age;
+      }
+
+      // Swap two entries and keep the index up to date
+      void swap(std::size_t a, std::size_t b) {
+        std::swap(heap_[a], heap_[b]);
+        index_.set(heap_[a].key, a);
+        index_.set(heap_[b].key, b);
+      }
+
+      // Move an entry towards the root, returning its new position
+      template <class Compare>
+      std::size_t siftUp(std::size_t i, const Compare& compare) {
+        while (i > 0) {
+          const std::size_t parent = (i - 1) / D;
+          if (!before(heap_[i], heap_[parent], compare)) { break; }
+          swap(i, parent);
+          i = parent;
+        }
+        return i;
+      }
+
+      // Move an entry towards the leaves, returning its new position
+      template <class Compare>
+      std::size_t siftDown(std::size_t i, const Compare& compare) {
+        while (true) {
+          const std::size_t first = i * D + 1;
+          if (first >= heap_.size()) { break; }
+          const std::size_t last = std::min(first + D, heap_.size());
+          std::size_t best = first;
+          for (std::size_t c = first + 1; c < last; ++c) {
+            if (before(heap_[c], heap_[best], compare)) { best = c; }
+          }
+          if (!before(heap_[best], heap_[i], compare)) { break; }
+          swap(i, best);
+          i = best;
+        }
+        return i;
+      }
+  };
+
+  // Heaps suitable for the A* controller
+  template <class K, class C> using BinaryHeap = IndexedHeap<K, C, 2>;
+  template <class K, class C> using QuaternaryHeap = IndexedHeap<K, C, 4>;
+
+  // An open list for focal search
+  // Keys within a bound of the lowest f form the 'focal' set, and the key
+  // expanded next is the one in the focal set with the lowest h
+  // The bound is a fraction, so f is in focal when f * den <= fmin * num
+  // It's kept in lowest terms so costs are scaled as little as possible
+  // - Keys in bounds are kept in a heap by h, and the rest in a heap by f
+  // - Keys move into focal as the lowest f and so the bound rises
+  // - If the bound falls, keys that are now out of bounds are only moved out
+  //   once they reach the top of focal
+  // As well as the usual interface, push and update take the key's h
+  // Templates: KEY, COST
+  template <class K, class C>
+  class FocalList {
+
+    static_assert(std::is_unsigned<K>::value, "Focal keys must be node ids");
+
+    public:
+
+      // Set the bound as a fraction of the lowest f, which must be >= 1
+      void setBound(unsigned int numerator, unsigned int denominator) {
+        assert(numerator >= denominator && denominator > 0);
+        const unsigned int divisor = std::gcd(numerator, denominator);
+        numerator_ = numerator / divisor;
+        denominator_ = denominator / divisor;
+        chosen_ = npos;
+      }
+
+      // Remove all entries
+      void clear() { 
+        byF_.clear(); 
+        focal_.clear(); 
+        outside_.clear(); 
+        h_.clear();
+        chosen_ = npos; 
+      }
+
+      // Query the size of the list
+      bool empty() const { return byF_.empty(); }
+      std::size_t size() const { return byF_.size(); }
+
+      // Check whether a key is in the list
+      bool contains(const K& key) const { return byF_.contains(key); }
+
+      // Insert a key that isn't already open
+      template <class Compare>
+      void push(const K& key, const C& f, const C& h, const Compare& compare) {
+        byF_.push(key, f, compare);
+        place(key, h, byF_.age(key), compare);
+      }
+
+      // Change the f and h values of an open key, keeping its age
+      template <class Compare>
+      void update(const K& key, const C& f, const C& h,
+          const Compare& compare) {
+        byF_.update(key, f, compare);
+        if (focal_.contains(key)) { focal_.erase(key, compare); }
+        else { outside_.erase(key, compare); }
+        place(key, h, byF_.age(key), compare);
+      }
+
+      // Retrieve the key in the focal set with the lowest h
+      // The key with the lowest f is always in bounds, so one is found
+      template <class Compare>
+      const K& top(const Compare& compare) {
+        assert(!byF_.empty());
+        if (chosen_ != npos) { return chosen_; }
+        const C bound = getBound(compare);
+
+        // Take in keys the bound has risen to cover
+        while (!outside_.empty()) {
+          const K key = outside_.top(compare);
+          if (!isInBounds(outside_.priority(key), bound, compare)) { break; }
+          const unsigned long age = outside_.age(key);
+          outside_.pop(compare);
+          focal_.push(key, h_[key], age, compare);
+        }
+
+        // Put back keys the bound has fallen below
+        while (true) {
+          const K key = focal_.top(compare);
+          const C& f = byF_.priority(key);
+          if (isInBounds(f, bound, compare)) {
+            chosen_ = key;
+            break;
+          }
+          const unsigned long age = focal_.age(key);
+          focal_.pop(compare);
+          outside_.push(key, f, age, compare);
+        }
+        return chosen_;
+      }
+
+      // Remove the key returned by top
+      template <class Compare>
+      void pop(const Compare& compare) {
+        const K key = top(compare);
+        byF_.erase(key, compare);
+        focal_.erase(key, compare);
+        chosen_ = npos;
+      }
+
+    private:
+
+      // Every open key ordered by f
+      QuaternaryHeap<K, C> byF_;
+
+      // Keys in bounds ordered by h, and the rest ordered by f
+      QuaternaryHeap<K, C> focal_;
+      QuaternaryHeap<K, C> outside_;
+
+      // The h value of every key, indexed by key
+      std::vector<C> h_;
+
+      // The bound as a fraction
+      unsigned int numerator_ = 1;
+      unsigned int denominator_ = 1;
+
+      // The key found by the last call to top, or npos if it's stale
+      static constexpr K npos = static_cast<K>(-1);
+      K chosen_ = npos;
+
+      // The highest f in bounds, scaled up by the denominator
+      template <class Compare>
+      C getBound(const Compare& compare) const {
+        return byF_.priority(byF_.top(compare)) * numerator_;
+      }
+
+      // Check whether an f value is in bounds
+      template <class Compare>
+      bool isInBounds(const C& f, const C& bound, 
+          const Compare& compare) const {
+        return !compare(bound, f * denominator_);
+      }
+
+      // Put a key in focal if it's in bounds, or set it aside if not
+      template <class Compare>
+      void place(const K& key, const C& h, unsigned long age, 
+          const Compare& compare) {
+        if (key >= h_.size()) { h_.resize(key + 1); }
+        h_[key] = h;
+        if (isInBounds(byF_.priority(key), getBound(compare), compare)) {
+          focal_.push(key, h, age, compare);
+        }
+        else {
+          outside_.push(key, byF_.priority(key), age, compare);
+        }
+        chosen_ = npos;
+      }
+  };
+}
+
+#endif
@@ -0,0 +1,616 @@
+// Controller/AStar/ParallelAStar.h
+// A controller that shares A* out across threads using Hash Distributed A*
+
+#ifndef CONTROLLER_PARALLELASTAR_H
+#define CONTROLLER_PARALLELASTAR_H
+
+#include "../Common.h"
+#include "OpenList.h"
+#include "NodeArena.h"
+
+#include <cassert>
+#include <vector>
+#include <algorithm>
+#include <stack>
+#include <utility>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <type_traits>
+
+// Seperate functions here from other controllers
+namespace Controller {
+
+  // Hash Distributed A* (HDA*)
+  // - Every state is owned by exactly one worker, chosen by its hash
+  // - Each worker keeps its own open list and arena of discovered states
+  // - Generated states are posted to their owner's lock-free mailbox
+  // - Closed states are reopened when a cheaper path to them arrives
+  // - Workers keep going after an endpoint is found until nothing left could
+  //   beat it, so the plan is as good as the serial search's
+  // - The search ends once no work is queued, in a mailbox or being expanded
+  // - Workers with nothing to do sleep until they're sent a state
+  // - Only measured on one core so far, where extra threads add overhead
+  //   and change how many states are expanded, so it's no faster than A*
+  //   there; the AI viewer can time it against threads on other machines
+  // Templates: thought STATE, ACTION, decision COST, HASH function
+  template <class S, class A, class C, class H = std::hash<S>>
+  class ParallelAStar {
+
+    public:
+
+      // Storage used for discovered states
+      typedef NodeArena<S, A, C, H> Arena;
+
+      // Public getters
+      unsigned int getThreads() const { return threads; }
+      const unsigned int& getStatesProcessed() const { return statesProcessed; }
+      unsigned long getGenerated() const { return generated; }
+      const Budget& getBudget() const { return budget; }
+      bool getBudgetExhausted() const { return budgetExhausted; }
+      bool getStopped() const { return stopped; }
+
+      // Number of states still waiting to be expanded
+      std::size_t getOpenCount() const {
+        std::size_t count = 0;
+        for (const auto& w : workers) { count += w->open.size(); }
+        return count;
+      }
+
+      // Number of states that have been expanded
+      std::size_t getClosedCount() const {
+        std::size_t count = 0;
+        for (const auto& w : workers) { count += w->arena.getClosedCount(); }
+        return count;
+      }
+
+      // Number of times the workers' tables have been searched
+      unsigned long getLookups() const {
+        unsigned long count = 0;
+        for (const auto& w : workers) { count += w->arena.getLookups(); }
+        return count;
+      }
+
+      // Number of slots inspected across all workers' searches
+      unsigned long getProbes() const {
+        unsigned long count = 0;
+        for (const auto& w : workers) { count += w->arena.getProbes(); }
+        return count;
+      }
+
+      // Set the number of threads future searches use
+      void setThreads(unsigned int n) { threads = n > 0 ? n : 1; }
+
+      // Limit the work done by future searches
+      void setBudget(const Budget& b) { budget = b; }
+
+      // Set the actions that finish a partial plan when the budget runs out
+      void setCompletion(const std::vector<A>& actions) { completion = actions; }
+
+      // Allow future searches to be abandoned from another thread
+      void setStopToken(const StopToken& token) { stopToken = token; }
+
+      // Free all memory held from the last search
+      void release() {
+        workers.clear();
+      }
+
+      // Evaluates options and returns a stack of actions to take
+      // Takes the same callables as AStar, which must be safe to call from
+      // several threads at once
+      template <class GetActions, class IsEndpoint, class Heuristic,
+          class WeighAction, class TakeAction, class Compare = std::less<C>>
+      std::pair<bool, std::stack<A>> operator() (
+          const S& startingState,
+          const C& minimumCost,
+          const C& maximumCost,
+          const GetActions& getPossibleActions,
+          const IsEndpoint& isStateEndpoint,
+          const Heuristic& heuristic,
+          const WeighAction& weighAction,
+          const TakeAction& takeAction,
+          const Compare& compareCost = Compare()) {
+
+        // Catch mismatched callables here rather than deep in the workers
+        static_assert(std::is_invocable_r_v<std::vector<A>,
+            const GetActions&, const S&>,
+            "getPossibleActions must be callable as (S) -> vector<A>");
+        static_assert(std::is_invocable_r_v<bool,
+            const IsEndpoint&, const S&, const S&>,
+            "isStateEndpoint must be callable as (S, S) -> bool");
+        static_assert(std::is_invocable_r_v<C, const Heuristic&, const S&>,
+            "heuristic must be callable as (S) -> C");
+        static_assert(std::is_invocable_r_v<C,
+            const WeighAction&, const S&, const S&, const S&, const A&>,
+            "weighAction must be callable as (S, S, S, A) -> C");
+        static_assert(std::is_invocable_v<const TakeAction&,
+            const S&, const A&>,
+            "takeAction must be callable as (S, A) -> pair<bool, S>");
+        static_assert(std::is_invocable_r_v<bool,
+            const Compare&, const C&, const C&>,
+            "compareCost must be callable as (C, C) -> bool");
+
+        // Reuse workers from the last search where possible
+        while (workers.size() > threads) { workers.pop_back(); }
+        while (workers.size() < threads) {
+          workers.emplace_back(std::make_unique<Worker>());
+        }
+        for (auto& w : workers) { w->clear(); }
+
+        // Reset the shared search state
+        Shared shared;
+        shared.startTime = std::chrono::steady_clock::now();
+
+        // Seed the owner of the starting state with it
+        shared.work = 1;
+        Worker& first = *workers[getOwner(startingState)];
+        first.mailbox.post(new Message{
+            startingState, minimumCost, Ref(), A(), nullptr});
+
+        // Run one worker on this thread and the rest on their own
+        const auto run = [&](unsigned int index) {
+          work(index, shared, startingState, maximumCost, getPossibleActions,
+              isStateEndpoint, heuristic, weighAction, takeAction,
+              compareCost);
+        };
+        std::vector<std::thread> pool;
+        for (unsigned int i = 1; i < threads; ++i) {
+          pool.emplace_back(run, i);
+        }
+        run(0);
+        for (auto& t : pool) { t.join(); }
+
+        // Throw away anything still waiting in a mailbox
+        for (auto& w : workers) { w->mailbox.drain(); }
+        statesProcessed =
+            static_cast<unsigned int>(shared.expansions.load());
+        generated = shared.generated;
+        budgetExhausted = shared.exhausted;
+        stopped = shared.stopped;
+
+        // Give up without a plan when asked to stop
+        if (stopped) {
+          return std::make_pair(false, std::stack<A>());
+        }
+
+        // Use the cheapest endpoint found if there is one
+        std::stack<A> actions;
+        if (shared.incumbent.isValid()) {
+          const bool success = buildPath(shared.incumbent, actions);
+          return std::make_pair(success, actions);
+        }
+
+        // If the budget ran out, settle for the most promising open state
+        if (budgetExhausted) {
+          return getBestOpen(startingState, isStateEndpoint, compareCost);
+        }
+
+        // Return unsuccessfully as no endpoint could be reached
+        return std::make_pair(false, actions);
+      }
+
+    private:
+
+      // Where a node lives: the worker that owns it and its id there
+      struct Ref {
+        unsigned int worker = 0;
+        NodeId id = invalidNode;
+        bool isValid() const { return id != invalidNode; }
+      };
+
+      // A generated state on its way to its owner
+      struct Message {
+        S state;
+        C g;
+        Ref parent;
+        A action;
+        Message* next;
+      };
+
+      // Lock-free multiple producer, single consumer mailbox
+      // Producers push onto a linked stack and the owner takes it all at once
+      class Mailbox {
+
+        public:
+
+          // Free anything still waiting
+          ~Mailbox() { drain(); }
+
+          // Add a message from any thread
+          void post(Message* message) {
+            message->next = head_.load(std::memory_order_relaxed);
+            while (!head_.compare_exchange_weak(message->next, message,
+                std::memory_order_release, std::memory_order_relaxed)) {}
+          }
+
+          // Check whether anything is waiting
+          bool isEmpty() const { return head_.load() == nullptr; }
+
+          // Take every waiting message, only called by the owner
+          Message* collect() {
+            if (head_.load(std::memory_order_relaxed) == nullptr) {
+              return nullptr;
+            }
+            return head_.exchange(nullptr, std::memory_order_acquire);
+          }
+
+          // Delete every waiting message
+          void drain() {
+            Message* message = collect();
+            while (message != nullptr) {
+              Message* next = message->next;
+              delete message;
+              message = next;
+            }
+          }
+
+        private:
+
+          // Most recently posted message
+          std::atomic<Message*> head_{nullptr};
+      };
+
+      // State shared by every worker during a search
+      struct Shared {
+
+        // Messages in flight plus open and expanding states, across workers
+        // The search is over once this reaches zero
+        std::atomic<long> work{0};
+
+        // Set when every worker should stop, and why
+        std::atomic<bool> done{false};
+        std::atomic<bool> exhausted{false};
+        std::atomic<bool> stopped{false};
+
+        // Totals used to enforce the budget
+        std::atomic<unsigned long> expansions{0};
+        std::atomic<unsigned long> nodes{0};
+
+        // Number of valid neighbours generated, added once per expansion
+        std::atomic<unsigned long> generated{0};
+        std::chrono::steady_clock::time_point startTime;
+
+        // Cheapest endpoint found so far
+        // Workers keep a copy and check the version to know when to refresh
+        std::mutex incumbentMutex;
+        std::atomic<unsigned int> incumbentVersion{0};
+        Ref incumbent;
+        C incumbentCost;
+      };
+
+      // Everything a single thread owns
+      struct Worker {
+
+        // States owned by this worker and their search data
+        Arena arena;
+
+        // Worker that owns the parent of each node, indexed by NodeId
+        std::vector<unsigned int> parentWorker;
+
+        // Owned states that still need exploring
+        OpenList::QuaternaryHeap<NodeId, C> open;
+
+        // States sent here by other workers
+        Mailbox mailbox;
+
+        // Lets the worker sleep while it has nothing to do
+        std::mutex parkMutex;
+        std::condition_variable parkCondition;
+        std::atomic<bool> isParked{false};
+
+        // Sleep until sent a state or the search is over
+        // Wakes up now and then regardless, to check for stop requests and
+        // the budget, and in case a wake up was missed
+        void park(const Shared& shared) {
+          std::unique_lock<std::mutex> lock(parkMutex);
+          isParked = true;
+          parkCondition.wait_for(lock, std::chrono::milliseconds(1), [&]() {
+            return !mailbox.isEmpty() || shared.work == 0 || shared.done;
+          });
+          isParked = false;
+        }
+
+        // Wake the worker if it's sleeping
+        void wake() {
+          if (!isParked) { return; }
+          std::lock_guard<std::mutex> lock(parkMutex);
+          parkCondition.notify_one();
+        }
+
+        // Forget the last search but keep memory around
+        void clear() {
+          arena.clear();
+          parentWorker.clear();
+          open.clear();
+          mailbox.drain();
+        }
+      };
+
+      // Workers, one per thread
+      std::vector<std::unique_ptr<Worker>> workers;
+
+      // Number of threads to search with
+      unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+
+      // Limits on the work done by a search
+      Budget budget;
+      bool budgetExhausted = false;
+
+      // Actions that finish a partial plan
+      std::vector<A> completion;
+
+      // Used to abandon a search early
+      StopToken stopToken;
+      bool stopped = false;
+
+      // Keep track of the number of states expanded and neighbours generated
+      unsigned int statesProcessed = 0;
+      unsigned long generated = 0;
+
+      // Find the worker that owns a state
+      // Uses the high bits of the hash so the arenas' tables stay balanced
+      unsigned int getOwner(const S& state) const {
+        const unsigned long long h = static_cast<unsigned long long>(
+            H()(state)) * 0x9e3779b97f4a7c15ULL;
+        return static_cast<unsigned int>((h >> 32) % workers.size());
+      }
+
+      // Check whether the search has used up its budget
+      bool hasExceededBudget(const Shared& shared) const {
+        if (budget.maxExpansions > 0
+            && shared.expansions >= budget.maxExpansions) {
+          return true;
+        }
+        if (budget.maxNodes > 0 && shared.nodes >= budget.maxNodes) {
+          return true;
+        }
+        if (budget.maxMilliseconds > 0) {
+          const auto elapsed =
+              std::chrono::steady_clock::now() - shared.startTime;
+          return elapsed >= std::chrono::milliseconds(budget.maxMilliseconds);
+        }
+        return false;
+      }
+
+      // The loop each worker runs until the search is over
+      template <class GetActions, class IsEndpoint, class Heuristic,
+          class WeighAction, class TakeAction, class Compare>
+      void work(
+          unsigned int index,
+          Shared& shared,
+          const S& startingState,
+          const C& maximumCost,
+          const GetActions& getPossibleActions,
+          const IsEndpoint& isStateEndpoint,
+          const Heuristic& heuristic,
+          const WeighAction& weighAction,
+          const TakeAction& takeAction,
+          const Compare& compareCost) {
+
+        Worker& self = *workers[index];
+
+        // Local copy of the cheapest endpoint's cost
+        bool hasIncumbent = false;
+        C incumbentCost = maximumCost;
+        unsigned int incumbentVersion = 0;
+
+        // Take in a state generated by any worker
+        // Consumes one unit of work unless the state is newly opened
+        const auto receive = [&](const S& state, const C& g,
+            const Ref& parent, const A& action) {
+
+          // Find the node, initialising it if it's new
+          const auto found = self.arena.insert(state);
+          const NodeId id = found.first;
+          if (found.second) {
+            self.arena[id].g = maximumCost;
+            self.parentWorker.push_back(0);
+            shared.nodes += 1;
+          }
+
+          // Ignore paths that aren't an improvement
+          auto& node = self.arena[id];
+          if (!compareCost(g, node.g)) {
+            shared.work -= 1;
+            return;
+          }
+
+          // Record how we got to this node and the improved scores
+          node.parent = parent.id;
+          node.action = action;
+          node.g = g;
+          node.f = g + heuristic(self.arena.getState(id));
+          self.parentWorker[id] = parent.worker;
+
+          // Don't bother exploring states that can't beat the incumbent
+          if (hasIncumbent && !compareCost(node.f, incumbentCost)) {
+            shared.work -= 1;
+            return;
+          }
+
+          // Queue the node, reopening it or reprioritising it as needed
+          if (self.open.contains(id)) {
+            self.open.update(id, node.f, compareCost);
+            shared.work -= 1;
+          }
+          else {
+            self.arena.reopen(id);
+            self.open.push(id, node.f, compareCost);
+          }
+        };
+
+        // Keep working until every worker agrees the search is over
+        while (!shared.done) {
+
+          // Stop everything if asked to or the budget has run out
+          if (stopToken.isStopRequested()) {
+            shared.stopped = true;
+            finish(shared);
+            break;
+          }
+          if (budget.isLimited() && hasExceededBudget(shared)) {
+            shared.exhausted = true;
+            finish(shared);
+            break;
+          }
+
+          // Take in states sent from other workers
+          Message* message = self.mailbox.collect();
+          while (message != nullptr) {
+            receive(message->state, message->g, message->parent,
+                message->action);
+            Message* next = message->next;
+            delete message;
+            message = next;
+          }
+
+          // Refresh the incumbent if another worker has improved it
+          if (shared.incumbentVersion != incumbentVersion) {
+            std::lock_guard<std::mutex> lock(shared.incumbentMutex);
+            incumbentVersion = shared.incumbentVersion;
+            incumbentCost = shared.incumbentCost;
+            hasIncumbent = shared.incumbent.isValid();
+          }
+
+          // With nothing to do, finish if no other work exists anywhere
+          // Otherwise wait to be sent something
+          if (self.open.empty()) {
+            if (shared.work == 0) {
+              finish(shared);
+            }
+            else {
+              self.park(shared);
+            }
+            continue;
+          }
+
+          // Get the highest priority state to operate on
+          const NodeId current = self.open.top(compareCost);
+          self.open.pop(compareCost);
+          self.arena.close(current);
+          const C g = self.arena[current].g;
+          const C f = self.arena[current].f;
+
+          // States that can't beat the incumbent aren't worth expanding
+          if (hasIncumbent && !compareCost(f, incumbentCost)) {
+            shared.work -= 1;
+            continue;
+          }
+
+          // Record endpoints instead of expanding them
+          const S& state = self.arena.getState(current);
+          if (isStateEndpoint(startingState, state)) {
+            std::lock_guard<std::mutex> lock(shared.incumbentMutex);
+            if (!shared.incumbent.isValid()
+                || compareCost(g, shared.incumbentCost)) {
+              shared.incumbent = Ref{index, current};
+              shared.incumbentCost = g;
+              shared.incumbentVersion += 1;
+            }
+            shared.work -= 1;
+            continue;
+          }
+
+          // @ANALYSIS: Record how many moves have been processed
+          shared.expansions += 1;
+
+          // Send every neighbour to the worker that owns it
+          const Ref from{index, current};
+          unsigned long neighbours = 0;
+          for (const A& action : getPossibleActions(state)) {
+            const auto& attempt = takeAction(state, action);
+            if (!attempt.first) { continue; }
+            neighbours += 1;
+            const S& future = attempt.second;
+            const C tentative_gScore = g +
+                weighAction(startingState, state, future, action);
+            shared.work += 1;
+            const unsigned int owner = getOwner(future);
+            if (owner == index) {
+              receive(future, tentative_gScore, from, action);
+            }
+            else {
+              workers[owner]->mailbox.post(new Message{
+                  future, tentative_gScore, from, action, nullptr});
+              workers[owner]->wake();
+            }
+          }
+
+          shared.generated.fetch_add(neighbours, std::memory_order_relaxed);
+
+          // The current state has been dealt with
+          shared.work -= 1;
+        }
+      }
+
+      // Tell every worker the search is over, waking any that are asleep
+      void finish(Shared& shared) {
+        shared.done = true;
+        for (auto& w : workers) { w->wake(); }
+      }
+
+      // Push the actions leading from the start to a node onto a stack
+      // Only safe once every worker has stopped
+      bool buildPath(Ref node, std::stack<A>& actions) const {
+        std::size_t total = 0;
+        for (const auto& w : workers) { total += w->arena.size(); }
+        while (true) {
+          const auto& arena = workers[node.worker]->arena;
+          const NodeId parent = arena[node.id].parent;
+          if (parent == invalidNode) { return true; }
+
+          // This shouldn't trigger as all routes should be traceable
+          // However, if it does, stop the infinite loop
+          if (actions.size() > total) {
+            assert(false);
+            return false;
+          }
+
+          // Add action to the stack and focus on the previous node
+          actions.push(arena[node.id].action);
+          node = Ref{workers[node.worker]->parentWorker[node.id], parent};
+        }
+      }
+
+      // Get the most promising open state across all workers
+      // The plan is finished with the completion actions if necessary
+      template <class IsEndpoint, class Compare>
+      std::pair<bool, std::stack<A>> getBestOpen(
+          const S& startingState,
+          const IsEndpoint& isStateEndpoint,
+          const Compare& compareCost) const {
+
+        // Each worker's best is at the top of its heap
+        Ref best;
+        for (unsigned int i = 0; i < workers.size(); ++i) {
+          const auto& w = *workers[i];
+          if (w.open.empty()) { continue; }
+          const NodeId id = w.open.top(compareCost);
+          if (!best.isValid() || compareCost(w.arena[id].f,
+              workers[best.worker]->arena[best.id].f)) {
+            best = Ref{i, id};
+          }
+        }
+        std::stack<A> actions;
+        if (!best.isValid()) {
+          return std::make_pair(false, actions);
+        }
+
+        // Finish the plan and then trace it back to the start
+        const auto& arena = workers[best.worker]->arena;
+        if (!isStateEndpoint(startingState, arena.getState(best.id))) {
+          for (auto it = completion.crbegin(); it != completion.crend(); ++it) {
+            actions.push(*it);
+          }
+        }
+        const bool success = buildPath(best, actions);
+        return std::make_pair(success, actions);
+      }
+  };
+}
+
+#endif
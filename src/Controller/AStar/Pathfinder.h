@@ -0,0 +1,263 @@
+// Controller/AStar/Pathfinder.h
+// Holds every variant of A* and makes decisions with whichever is chosen
+
+#ifndef CONTROLLER_PATHFINDER_H
+#define CONTROLLER_PATHFINDER_H
+
+#include "../Common.h"
+#include "AStar.h"
+#include "ParallelAStar.h"
+#include "IDAStar.h"
+#include "SMAStar.h"
+#include "BeamSearch.h"
+
+#include <vector>
+#include <stack>
+#include <utility>
+#include <functional>
+#include <chrono>
+
+// Seperate functions here from other controllers
+namespace Controller {
+
+  // Chooses between the A* variants at run time
+  // - Every variant takes the same callables, so a decision can be handed
+  //   to any of them
+  // - Settings are passed on to every variant, each using what it needs
+  // - Getters report on the variant that was chosen last
+  // - A* can store states through a CODEC instead, when asked to and the
+  //   starting state allows it, otherwise it stores them as they are
+  // Templates: thought STATE, ACTION, decision COST, CODEC for packed A*
+  template <class S, class A, class C, class Codec = IdentityCodec<S, A>>
+  class Pathfinder {
+
+    public:
+
+      // A* storing states and actions through the codec
+      typedef AStar<S, A, C, OpenList::QuaternaryHeap, Codec> PackedAStar;
+
+      // Public getters
+      Algorithm getAlgorithm() const { return algorithm; }
+      bool getPacking() const { return isPacking; }
+      const AStar<S, A, C>& getAStar() const { return astar; }
+      const PackedAStar& getPackedAStar() const { return packedAStar; }
+      const ParallelAStar<S, A, C>& getParallelAStar() const {
+        return parallelAStar;
+      }
+      const IDAStar<S, A, C>& getIDAStar() const { return idaStar; }
+      const SMAStar<S, A, C>& getSMAStar() const { return smaStar; }
+      const BeamSearch<S, A, C>& getBeamSearch() const { return beamSearch; }
+
+      // The action A* is currently looking at, and its cost
+      const std::pair<A, C>& getCurrentAction() const {
+        return usedPacked 
+            ? packedAStar.getCurrentAction() : astar.getCurrentAction();
+      }
+
+      // Call f with the search data of every node A* discovered
+      template <class F>
+      void forEachNode(const F& f) const {
+        const auto each = [&f](const auto& search) {
+          for (const auto& node : search.getArena().getNodes()) { f(node); }
+        };
+        if (usedPacked) { each(packedAStar); } else { each(astar); }
+      }
+
+      // Number of states processed so far
+      unsigned int getStatesProcessed() const {
+        return visit([](const auto& s) { return s.getStatesProcessed(); });
+      }
+
+      // Number of states waiting to be looked at
+      std::size_t getOpenCount() const {
+        return visit([](const auto& s) { return s.getOpenCount(); });
+      }
+
+      // Number of states that have been looked at and kept
+      std::size_t getClosedCount() const {
+        return visit([](const auto& s) { return s.getClosedCount(); });
+      }
+
+      // Number of times the closed set has been searched
+      unsigned long getLookups() const {
+        return visit([](const auto& s) { return s.getLookups(); });
+      }
+
+      // Number of slots inspected while searching the closed set
+      unsigned long getProbes() const {
+        return visit([](const auto& s) { return s.getProbes(); });
+      }
+
+      // Whether the last decision ran out of budget
+      bool getBudgetExhausted() const {
+        return visit([](const auto& s) { return s.getBudgetExhausted(); });
+      }
+
+      // Whether the last decision was abandoned
+      bool getStopped() const {
+        return visit([](const auto& s) { return s.getStopped(); });
+      }
+
+      // Measurements of the last decision
+      // Only A* is fully instrumented, the other variants just report how
+      // many states they expanded and generated, and how long they took
+      SearchStats getStats() const {
+        if (algorithm == Algorithm::AStar) {
+          return usedPacked ? packedAStar.getStats() : astar.getStats();
+        }
+        SearchStats result;
+        result.expanded = getStatesProcessed();
+        result.generated = 
+            visit([](const auto& s) { return s.getGenerated(); });
+        result.milliseconds = milliseconds;
+        result.isPartial = true;
+        return result;
+      }
+
+      // Choose the variant future decisions are made with
+      void setAlgorithm(Algorithm a) { algorithm = a; }
+
+      // Choose whether A* stores packed states where it can
+      void setPacking(bool enable) { isPacking = enable; }
+
+      // Limit the work done by future searches
+      void setBudget(const Budget& b) {
+        astar.setBudget(b);
+        packedAStar.setBudget(b);
+        parallelAStar.setBudget(b);
+        idaStar.setBudget(b);
+        smaStar.setBudget(b);
+        beamSearch.setBudget(b);
+      }
+
+      // Set the actions that finish a partial plan when the budget runs out
+      void setCompletion(const std::vector<A>& actions) {
+        astar.setCompletion(actions);
+        packedAStar.setCompletion(actions);
+        parallelAStar.setCompletion(actions);
+        idaStar.setCompletion(actions);
+        smaStar.setCompletion(actions);
+        beamSearch.setCompletion(actions);
+      }
+
+      // Allow future searches to be abandoned from another thread
+      void setStopToken(const StopToken& token) {
+        astar.setStopToken(token);
+        packedAStar.setStopToken(token);
+        parallelAStar.setStopToken(token);
+        idaStar.setStopToken(token);
+        smaStar.setStopToken(token);
+        beamSearch.setStopToken(token);
+      }
+
+      // Settings only some variants make use of
+      void setThreads(unsigned int n) { parallelAStar.setThreads(n); }
+      void setSuccessorThreads(unsigned int n) { 
+        astar.setSuccessorThreads(n); 
+        packedAStar.setSuccessorThreads(n); 
+      }
+      void setSuboptimality(const Suboptimality& s) {
+        astar.setSuboptimality(s);
+        packedAStar.setSuboptimality(s);
+      }
+      void setBeamWidth(unsigned int w) { beamSearch.setWidth(w); }
+      void setTieBreak(TieBreak t) { 
+        astar.setTieBreak(t); 
+        packedAStar.setTieBreak(t); 
+      }
+      void setTieBreakKey(const std::function<unsigned long(const S&)>& key) {
+        astar.setTieBreakKey(key);
+        packedAStar.setTieBreakKey(key);
+      }
+      void setTimingCallbacks(bool enable) {
+        astar.setTimingCallbacks(enable);
+        packedAStar.setTimingCallbacks(enable);
+      }
+      void setSearchLog(SearchLog<A>* log, 
+          const std::function<float(const C&)>& score) {
+        astar.setSearchLog(log, score);
+        packedAStar.setSearchLog(log, score);
+      }
+
+      // Free all memory held from the last search
+      void release() {
+        astar.release();
+        packedAStar.release();
+        parallelAStar.release();
+        idaStar.release();
+        smaStar.release();
+        beamSearch.release();
+      }
+
+      // Evaluates options with the chosen variant
+      template <class GetActions, class IsEndpoint, class Heuristic,
+          class WeighAction, class TakeAction, class Compare = std::less<C>>
+      std::pair<bool, std::stack<A>> operator() (
+          const S& startingState,
+          const C& minimumCost,
+          const C& maximumCost,
+          const GetActions& getPossibleActions,
+          const IsEndpoint& isStateEndpoint,
+          const Heuristic& heuristic,
+          const WeighAction& weighAction,
+          const TakeAction& takeAction,
+          const Compare& compareCost = Compare()) {
+        const auto decide = [&](auto& search) {
+          return search(startingState, minimumCost, maximumCost,
+              getPossibleActions, isStateEndpoint, heuristic,
+              weighAction, takeAction, compareCost);
+        };
+        const auto timed = [&](auto& search) {
+          const auto startTime = std::chrono::steady_clock::now();
+          const auto result = decide(search);
+          milliseconds = std::chrono::duration<double, std::milli>(
+              std::chrono::steady_clock::now() - startTime).count();
+          return result;
+        };
+        switch (algorithm) {
+          case Algorithm::ParallelAStar: return timed(parallelAStar);
+          case Algorithm::IDAStar: return timed(idaStar);
+          case Algorithm::SMAStar: return timed(smaStar);
+          case Algorithm::BeamSearch: return timed(beamSearch);
+          default: break;
+        }
+        usedPacked = isPacking 
+            && packedAStar.getCodec().canEncode(startingState);
+        return usedPacked ? decide(packedAStar) : decide(astar);
+      }
+
+    private:
+
+      // The variant to make decisions with
+      Algorithm algorithm = Algorithm::AStar;
+
+      // Whether A* should pack states, and whether the last decision did
+      bool isPacking = false;
+      bool usedPacked = false;
+
+      // Time taken by the last decision made without A*
+      double milliseconds = 0.0;
+
+      // Every variant, kept so their memory can be reused between decisions
+      AStar<S, A, C> astar;
+      PackedAStar packedAStar;
+      ParallelAStar<S, A, C> parallelAStar;
+      IDAStar<S, A, C> idaStar;
+      SMAStar<S, A, C> smaStar;
+      BeamSearch<S, A, C> beamSearch;
+
+      // Call f on the chosen variant
+      template <class F>
+      auto visit(const F& f) const {
+        switch (algorithm) {
+          case Algorithm::ParallelAStar: return f(parallelAStar);
+          case Algorithm::IDAStar: return f(idaStar);
+          case Algorithm::SMAStar: return f(smaStar);
+          case Algorithm::BeamSearch: return f(beamSearch);
+          default: return usedPacked ? f(packedAStar) : f(astar);
+        }
+      }
+  };
+}
+
+#endif
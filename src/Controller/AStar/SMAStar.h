@@ -0,0 +1,431 @@
+// Controller/AStar/SMAStar.h
+// A controller that employs Simplified Memory-bounded A* to cap memory use
+
+#ifndef CONTROLLER_SMASTAR_H
+#define CONTROLLER_SMASTAR_H
+
+#include "../Common.h"
+
+#include <vector>
+#include <deque>
+#include <set>
+#include <unordered_map>
+#include <stack>
+#include <utility>
+#include <chrono>
+#include <functional>
+#include <type_traits>
+
+// Seperate functions here from other controllers
+namespace Controller {
+
+  // Simplified Memory-bounded A* (SMA*)
+  // - Grows a search tree best-first, one successor at a time, preferring
+  //   the deepest of the states with the lowest f
+  // - The node limit of the budget is a hard cap on the size of the tree
+  //   rather than a reason to stop: once it's full, the shallowest of the
+  //   leaves with the highest f is forgotten
+  // - A forgotten state's f is remembered by its parent so the parent knows
+  //   when it's worth generating it again
+  // - A state's f is backed up to the lowest f of its successors once they
+  //   have all been generated
+  // - Successors are dropped if the same state is already in memory for no
+  //   more cost, which also stops the search going round in cycles
+  // Takes the same callables as AStar
+  // Templates: thought STATE, ACTION, decision COST, HASH function
+  template <class S, class A, class C, class H = std::hash<S>>
+  class SMAStar {
+
+    public:
+
+      // Public getters
+      const unsigned int& getStatesProcessed() const { return statesProcessed; }
+      unsigned long getGenerated() const { return generated; }
+      std::size_t getOpenCount() const { return openCount; }
+      std::size_t getClosedCount() const { return nodeCount - openCount; }
+      std::size_t getForgottenCount() const { return forgottenCount; }
+      unsigned long getLookups() const { return 0; }
+      unsigned long getProbes() const { return 0; }
+      bool getBudgetExhausted() const { return budgetExhausted; }
+      bool getStopped() const { return stopped; }
+
+      // Limit the work done by future searches
+      // The node limit caps the size of the tree instead of ending the search
+      void setBudget(const Budget& b) { budget = b; }
+
+      // Set the actions that finish a partial plan when the budget runs out
+      void setCompletion(const std::vector<A>& actions) { completion = actions; }
+
+      // Allow future searches to be abandoned from another thread
+      void setStopToken(const StopToken& token) { stopToken = token; }
+
+      // Free all memory held from the last search
+      void release() {
+        std::deque<Node>().swap(nodes);
+        std::vector<Node*>().swap(freeNodes);
+        std::unordered_map<S, Node*, H>().swap(cheapest);
+        nodeCount = 0;
+        openCount = 0;
+      }
+
+      // Evaluates options and returns a stack of actions to take
+      template <class GetActions, class IsEndpoint, class Heuristic,
+          class WeighAction, class TakeAction, class Compare = std::less<C>>
+      std::pair<bool, std::stack<A>> operator() (
+          const S& startingState,
+          const C& minimumCost,
+          const C& maximumCost,
+          const GetActions& getPossibleActions,
+          const IsEndpoint& isStateEndpoint,
+          const Heuristic& heuristic,
+          const WeighAction& weighAction,
+          const TakeAction& takeAction,
+          const Compare& compareCost = Compare()) {
+
+        // Prepare to search
+        release();
+        statesProcessed = 0;
+        generated = 0;
+        forgottenCount = 0;
+        budgetExhausted = false;
+        stopped = false;
+        serial = 0;
+        const auto startTime = std::chrono::steady_clock::now();
+
+        // Best states to generate from come first: lowest f, then deepest
+        const auto isBetter = [&compareCost](const Node* a, const Node* b) {
+          if (compareCost(a->f, b->f)) { return true; }
+          if (compareCost(b->f, a->f)) { return false; }
+          if (a->depth != b->depth) { return a->depth > b->depth; }
+          return a->serial < b->serial;
+        };
+
+        // Worst leaves to forget come first: highest f, then shallowest
+        const auto isWorse = [&compareCost](const Node* a, const Node* b) {
+          if (compareCost(b->f, a->f)) { return true; }
+          if (compareCost(a->f, b->f)) { return false; }
+          if (a->depth != b->depth) { return a->depth < b->depth; }
+          return a->serial < b->serial;
+        };
+
+        // States that can still generate a successor, and states without
+        // any successors in memory
+        std::set<Node*, decltype(isBetter)> open(isBetter);
+        std::set<Node*, decltype(isWorse)> leaves(isWorse);
+
+        // Anything that changes a node's ordering must take it out first
+        const auto detach = [&](Node* node) {
+          open.erase(node);
+          leaves.erase(node);
+        };
+        const auto attach = [&](Node* node) {
+          if (canGenerate(node)) { open.insert(node); }
+          if (node->inMemory == 0 && node->parent) { leaves.insert(node); }
+          openCount = open.size();
+        };
+
+        // The largest of two costs
+        const auto larger = [&compareCost](const C& a, const C& b) {
+          return compareCost(a, b) ? b : a;
+        };
+
+        // Set a node's f to the lowest f of its successors once they've all
+        // been generated, and pass any change up the tree
+        const auto backUp = [&](Node* node) {
+          while (node && node->isExpanded) {
+            bool hasValid = false;
+            C lowest = maximumCost;
+            for (const Child& child : node->children) {
+              if (child.status == Child::Status::Unseen) { return; }
+              if (child.status == Child::Status::Invalid) { continue; }
+              const C& f = child.status == Child::Status::InMemory
+                  ? child.node->f : child.f;
+              if (!hasValid || compareCost(f, lowest)) {
+                lowest = f;
+                hasValid = true;
+              }
+            }
+            if (!compareCost(node->f, lowest) && !compareCost(lowest, node->f)) {
+              return;
+            }
+            detach(node);
+            node->f = lowest;
+            attach(node);
+            node = node->parent;
+          }
+        };
+
+        // Forget the worst leaf, leaving its f with its parent
+        const auto forget = [&]() {
+          Node* leaf = *leaves.begin();
+          Node* parent = leaf->parent;
+          detach(leaf);
+          detach(parent);
+          for (Child& child : parent->children) {
+            if (child.node == leaf) {
+              child.status = Child::Status::Forgotten;
+              child.node = nullptr;
+              child.f = leaf->f;
+              break;
+            }
+          }
+          parent->inMemory -= 1;
+          attach(parent);
+          recycle(leaf);
+          forgottenCount += 1;
+        };
+
+        // Start from the root
+        Node* root = allocate(startingState, minimumCost,
+            minimumCost + heuristic(startingState), nullptr, A());
+        attach(root);
+
+        // Keep generating successors until the best state is a goal
+        while (true) {
+
+          // Give up if asked to
+          if (stopToken.isStopRequested()) {
+            stopped = true;
+            return std::make_pair(false, std::stack<A>());
+          }
+
+          // Fail if there's nothing left that could lead to a goal
+          if (open.empty() || !compareCost((*open.begin())->f, maximumCost)) {
+            return std::make_pair(false, std::stack<A>());
+          }
+          Node* node = *open.begin();
+
+          // If we've arrived at a node that can be considered the goal, stop
+          if (isStateEndpoint(startingState, node->state)) {
+            return std::make_pair(true, buildPlan(node));
+          }
+
+          // If the budget has run out, settle for the best state so far
+          if (hasExceededBudget(startTime)) {
+            budgetExhausted = true;
+            return getBestPlan(node);
+          }
+
+          // @ANALYSIS: Record how many moves have been processed
+          statesProcessed += 1;
+
+          // Find out what the state's successors are the first time round
+          if (!node->isExpanded) {
+            for (const A& action : getPossibleActions(node->state)) {
+              node->children.push_back(Child{action});
+            }
+            node->isExpanded = true;
+          }
+
+          // Generate a successor not seen yet, otherwise the forgotten
+          // successor with the lowest f
+          Child* next = nullptr;
+          for (Child& child : node->children) {
+            if (child.status == Child::Status::Unseen) {
+              next = &child;
+              break;
+            }
+            if (child.status == Child::Status::Forgotten
+                && (!next || compareCost(child.f, next->f))) {
+              next = &child;
+            }
+          }
+          detach(node);
+          if (!next) {
+            backUp(node);
+            attach(node);
+            continue;
+          }
+
+          // Skip actions that fail or reach a state already in memory for no
+          // more cost, as anything found from here can be found from there
+          const auto& attempt = takeAction(node->state, next->action);
+          const S& future = attempt.second;
+          if (attempt.first) { generated += 1; }
+          const C g = attempt.first ? node->g +
+              weighAction(startingState, node->state, future, next->action)
+              : maximumCost;
+          const auto known = attempt.first
+              ? cheapest.find(future) : cheapest.end();
+          if (!attempt.first || (known != cheapest.end()
+              && !compareCost(g, known->second->g))) {
+            next->status = Child::Status::Invalid;
+            attach(node);
+            backUp(node);
+            continue;
+          }
+
+          // A successor is never more promising than its parent
+          C f = larger(node->f, g + heuristic(future));
+          if (next->status == Child::Status::Forgotten) {
+            f = larger(f, next->f);
+          }
+
+          // A successor that fills the tree can't lead anywhere else
+          if (budget.maxNodes > 0 && node->depth + 2 >= budget.maxNodes
+              && !isStateEndpoint(startingState, future)) {
+            f = maximumCost;
+          }
+
+          // Add the successor to the tree
+          Node* child = allocate(future, g, f, node, next->action);
+          next->status = Child::Status::InMemory;
+          next->node = child;
+          node->inMemory += 1;
+          attach(node);
+          attach(child);
+          backUp(node);
+
+          // Make room by forgetting the worst leaves
+          while (budget.maxNodes > 0 && nodeCount > budget.maxNodes
+              && !leaves.empty()) {
+            forget();
+          }
+        }
+      }
+
+    private:
+
+      struct Node;
+
+      // A successor of a node, remembered even once it's forgotten
+      struct Child {
+        enum class Status { Unseen, InMemory, Forgotten, Invalid };
+        A action;
+        Status status = Status::Unseen;
+        Node* node = nullptr;
+        C f = C();
+      };
+
+      // A state in the search tree
+      struct Node {
+        S state;
+        C g;
+        C f;
+        Node* parent = nullptr;
+        A action;
+        unsigned int depth = 0;
+        unsigned long serial = 0;
+        std::vector<Child> children;
+        unsigned int inMemory = 0;
+        bool isExpanded = false;
+      };
+
+      // Storage for nodes, reused once forgotten
+      std::deque<Node> nodes;
+      std::vector<Node*> freeNodes;
+
+      // The cheapest node in memory for each state
+      std::unordered_map<S, Node*, H> cheapest;
+      std::size_t nodeCount = 0;
+      std::size_t openCount = 0;
+      unsigned long serial = 0;
+
+      // Limits on the work done by a search
+      Budget budget;
+      bool budgetExhausted = false;
+
+      // Actions that finish a partial plan
+      std::vector<A> completion;
+
+      // Used to abandon a search early
+      StopToken stopToken;
+      bool stopped = false;
+
+      // Keep track of the work done
+      unsigned int statesProcessed = 0;
+      unsigned long generated = 0;
+      std::size_t forgottenCount = 0;
+
+      // Whether a node has successors left to generate
+      static bool canGenerate(const Node* node) {
+        if (!node->isExpanded) { return true; }
+        for (const Child& child : node->children) {
+          if (child.status == Child::Status::Unseen
+              || child.status == Child::Status::Forgotten) {
+            return true;
+          }
+        }
+        return false;
+      }
+
+      // Take a node from storage
+      Node* allocate(const S& state, const C& g, const C& f,
+          Node* parent, const A& action) {
+        Node* node;
+        if (freeNodes.empty()) {
+          nodes.emplace_back();
+          node = &nodes.back();
+        }
+        else {
+          node = freeNodes.back();
+          freeNodes.pop_back();
+        }
+        node->state = state;
+        node->g = g;
+        node->f = f;
+        node->parent = parent;
+        node->action = action;
+        node->depth = parent ? parent->depth + 1 : 0;
+        node->serial = serial++;
+        node->children.clear();
+        node->inMemory = 0;
+        node->isExpanded = false;
+        cheapest[state] = node;
+        nodeCount += 1;
+        return node;
+      }
+
+      // Return a node to storage
+      void recycle(Node* node) {
+        const auto known = cheapest.find(node->state);
+        if (known != cheapest.end() && known->second == node) {
+          cheapest.erase(known);
+        }
+        node->children.clear();
+        freeNodes.push_back(node);
+        nodeCount -= 1;
+      }
+
+      // Check whether the search has used up its budget
+      // The node limit is handled by forgetting states instead
+      bool hasExceededBudget(
+          const std::chrono::steady_clock::time_point& startTime) const {
+        if (budget.maxExpansions > 0
+            && statesProcessed >= budget.maxExpansions) {
+          return true;
+        }
+        if (budget.maxMilliseconds > 0) {
+          const auto elapsed = std::chrono::steady_clock::now() - startTime;
+          return elapsed >= std::chrono::milliseconds(budget.maxMilliseconds);
+        }
+        return false;
+      }
+
+      // Push the actions leading from the root to node onto a stack
+      static void pushPath(const Node* node, std::stack<A>& actions) {
+        for (; node->parent; node = node->parent) {
+          actions.push(node->action);
+        }
+      }
+
+      // Turn the path to a node into a stack of actions
+      static std::stack<A> buildPlan(const Node* node) {
+        std::stack<A> actions;
+        pushPath(node, actions);
+        return actions;
+      }
+
+      // Get the path to the best node, finished with completion
+      std::pair<bool, std::stack<A>> getBestPlan(const Node* node) const {
+        std::stack<A> actions;
+        for (auto it = completion.crbegin(); it != completion.crend(); ++it) {
+          actions.push(*it);
+        }
+        pushPath(node, actions);
+        return std::make_pair(true, actions);
+      }
+  };
+}
+
+#endif
@@ -0,0 +1,168 @@
+// Controller/AStar/SearchLog.h
+// A compact record of the order a search expanded states in
+
+#ifndef CONTROLLER_ASTAR_SEARCHLOG_H
+#define CONTROLLER_ASTAR_SEARCHLOG_H
+
+#include "NodeArena.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+
+// Seperate functions here from other controllers
+namespace Controller {
+
+  // Every state a search expanded, in order, so it can be replayed later
+  // - Costs are stored as scores, as only the search knows its cost type
+  // - The start state isn't stored, but callers can keep whatever they need
+  //   to rebuild it in the context string
+  // - Saved as a small header followed by each entry field by field, with
+  //   actions written and read by the caller
+  // - Loading checks every size and depth against what's left of the file,
+  //   so a damaged log is refused rather than read
+  // Templates: thought ACTION
+  template <class A>
+  class SearchLog {
+
+    public:
+
+      // An expanded state and how it was reached
+      struct Entry {
+        NodeId node;
+        NodeId parent;
+        std::uint32_t depth;
+        A action;
+        float g;
+        float h;
+        bool isEndpoint;
+      };
+
+      // Public getters
+      const std::vector<Entry>& getEntries() const { return entries; }
+      const std::string& getContext() const { return context; }
+      std::size_t size() const { return entries.size(); }
+      bool empty() const { return entries.empty(); }
+
+      // Set anything needed to make sense of the log
+      void setContext(const std::string& c) { context = c; }
+
+      // Forget everything recorded
+      void clear() {
+        entries.clear();
+        context.clear();
+      }
+
+      // Add an expanded state to the end of the log
+      void record(const Entry& entry) { entries.push_back(entry); }
+
+      // Write the log in binary
+      // Write action is called as (out, action) for every entry
+      template <class WriteAction>
+      void save(std::ostream& out, const WriteAction& writeAction) const {
+        write(out, magic);
+        write(out, version);
+        write(out, (std::uint64_t)context.size());
+        out.write(context.data(), context.size());
+        write(out, (std::uint64_t)entries.size());
+        for (const Entry& entry : entries) {
+          write(out, (std::uint32_t)entry.node);
+          write(out, (std::uint32_t)entry.parent);
+          write(out, entry.depth);
+          writeAction(out, entry.action);
+          write(out, entry.g);
+          write(out, entry.h);
+          write(out, (std::uint8_t)entry.isEndpoint);
+        }
+      }
+
+      // Read a log written by save, returning whether it was understood
+      // Read action is called as (in, action) for every entry, and returns
+      // whether the action read was valid
+      template <class ReadAction>
+      bool load(std::istream& in, const ReadAction& readAction) {
+        clear();
+        const std::uint64_t remaining = getRemaining(in);
+        std::uint32_t m = 0, v = 0;
+        std::uint64_t contextSize = 0, count = 0;
+        if (!read(in, m) || m != magic || !read(in, v) || v != version
+            || !read(in, contextSize) || contextSize > maxContextSize
+            || contextSize > remaining) {
+          return false;
+        }
+        context.resize(contextSize);
+        in.read(&context[0], contextSize);
+
+        // Every entry takes at least its fixed fields, so a count the rest
+        // of the file can't hold is refused before any are read
+        if (!in || !read(in, count) || count > maxEntries
+            || count > (remaining - contextSize) / fixedEntrySize) {
+          clear();
+          return false;
+        }
+        entries.reserve(count);
+        for (std::uint64_t i = 0; i < count; ++i) {
+          Entry entry;
+          std::uint8_t isEndpoint = 0;
+          if (!read(in, entry.node) || !read(in, entry.parent)
+              || !read(in, entry.depth) || entry.depth >= count
+              || !readAction(in, entry.action) || !read(in, entry.g)
+              || !read(in, entry.h) || !read(in, isEndpoint)
+              || isEndpoint > 1) {
+            clear();
+            return false;
+          }
+          entry.isEndpoint = isEndpoint != 0;
+          entries.push_back(entry);
+        }
+        return true;
+      }
+
+    private:
+
+      // Marks the start of a log file and its layout
+      static constexpr std::uint32_t magic = 0x474c5253;
+      static constexpr std::uint32_t version = 2;
+
+      // Most a log may hold when loaded
+      static constexpr std::uint64_t maxContextSize = 1 << 16;
+      static constexpr std::uint64_t maxEntries = 1 << 26;
+
+      // Bytes each entry takes besides its action
+      static constexpr std::uint64_t fixedEntrySize = 3 * sizeof(std::uint32_t)
+          + 2 * sizeof(float) + sizeof(std::uint8_t);
+
+      // Every expanded state in order
+      std::vector<Entry> entries;
+
+      // Whatever the caller needs to rebuild the start state
+      std::string context;
+
+      // Read and write plain values
+      template <class T>
+      static void write(std::ostream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+      }
+      template <class T>
+      static bool read(std::istream& in, T& value) {
+        return (bool)in.read(reinterpret_cast<char*>(&value), sizeof(T));
+      }
+
+      // Number of bytes left to read, or as many as could be if unknown
+      static std::uint64_t getRemaining(std::istream& in) {
+        const auto start = in.tellg();
+        if (start < 0 || !in.seekg(0, std::ios_base::end)) {
+          in.clear();
+          return UINT64_MAX;
+        }
+        const auto end = in.tellg();
+        in.seekg(start);
+        return end > start ? (std::uint64_t)(end - start) : 0;
+      }
+  };
+}
+
+#endif
@@ -0,0 +1,158 @@
+// Controller/AStar/SearchStats.h
+// Measurements of the work done by a search and where its time went
+
+#ifndef CONTROLLER_ASTAR_SEARCHSTATS_H
+#define CONTROLLER_ASTAR_SEARCHSTATS_H
+
+#include <cstddef>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <sstream>
+
+// Seperate functions here from other controllers
+namespace Controller {
+
+  // Number of calls made to a callable and the time spent inside it
+  struct CallbackStats {
+    unsigned long calls = 0;
+    double milliseconds = 0.0;
+  };
+
+  // Everything measured while making one decision
+  struct SearchStats {
+
+    // Number of states whose neighbours were generated
+    unsigned long expanded = 0;
+
+    // Number of valid neighbours generated
+    unsigned long generated = 0;
+
+    // Number of neighbours that had already been discovered
+    unsigned long duplicates = 0;
+
+    // Number of open states found again by a cheaper path, and so moved
+    // up the open list
+    // Closed states are never reopened, so this doesn't count reopenings
+    unsigned long reprioritised = 0;
+
+    // Number of times the closed set was searched, and how often a state
+    // was compared against a different state with the same full hash
+    unsigned long lookups = 0;
+    unsigned long hashCollisions = 0;
+
+    // Most states held at once, and roughly how much memory they needed
+    // States that own heap memory need more than is counted here
+    std::size_t peakOpen = 0;
+    std::size_t peakClosed = 0;
+    std::size_t approximateBytes = 0;
+
+    // Time spent inside each of the callables, if they were timed
+    CallbackStats getPossibleActions;
+    CallbackStats takeAction;
+    CallbackStats weighAction;
+    CallbackStats heuristic;
+    CallbackStats isStateEndpoint;
+
+    // Number of expansions by how many valid neighbours they generated
+    // The last bucket counts every expansion with at least that many
+    std::array<unsigned long, 17> branching = {};
+
+    // Time taken by the whole search
+    double milliseconds = 0.0;
+
+    // Whether only expanded, generated and milliseconds were measured
+    // Searches other than A* don't keep track of anything else
+    bool isPartial = false;
+
+    // Fraction of lookups that ran into a full hash collision
+    double getCollisionRate() const {
+      return lookups > 0 ? (double)hashCollisions / lookups : 0.0;
+    }
+
+    // Average number of valid neighbours per expansion
+    double getBranchingFactor() const {
+      return expanded > 0 ? (double)generated / expanded : 0.0;
+    }
+
+    // Write the stats as a single line of JSON
+    std::string toJson() const {
+      std::ostringstream out;
+      const auto callback = [&out](const char* name, const CallbackStats& c) {
+        out << "\"" << name << "\":{\"calls\":" << c.calls
+            << ",\"ms\":" << c.milliseconds << "},";
+      };
+      out << "{\"expanded\":" << expanded
+          << ",\"generated\":" << generated;
+      if (isPartial) {
+        out << ",\"ms\":" << milliseconds << ",\"partial\":true}";
+        return out.str();
+      }
+      out << ",\"duplicates\":" << duplicates
+          << ",\"reprioritised\":" << reprioritised
+          << ",\"lookups\":" << lookups
+          << ",\"hashCollisions\":" << hashCollisions
+          << ",\"peakOpen\":" << peakOpen
+          << ",\"peakClosed\":" << peakClosed
+          << ",\"approximateBytes\":" << approximateBytes
+          << ",\"ms\":" << milliseconds
+          << ",\"callbacks\":{";
+      callback("getPossibleActions", getPossibleActions);
+      callback("takeAction", takeAction);
+      callback("weighAction", weighAction);
+      callback("heuristic", heuristic);
+      callback("isStateEndpoint", isStateEndpoint);
+      out.seekp(-1, std::ios_base::cur);
+      out << "},\"branching\":[";
+      for (std::size_t i = 0; i < branching.size(); ++i) {
+        out << (i > 0 ? "," : "") << branching[i];
+      }
+      out << "]}";
+      return out.str();
+    }
+  };
+
+  // Counts the calls made to a callable and the time spent inside it
+  // Safe to share between threads scoring neighbours at once
+  class CallbackTimer {
+
+    public:
+
+      // Forget everything counted so far
+      void reset() {
+        calls = 0;
+        nanoseconds = 0;
+      }
+
+      // Get what's been counted so far
+      CallbackStats get() const {
+        return CallbackStats{calls.load(), nanoseconds.load() / 1e6};
+      }
+
+      // Wrap a callable so every call to it is counted
+      // The timer and the callable must outlive the wrapper
+      // Every call reads the clock twice, so only wrap when measuring
+      template <class F>
+      auto wrap(const F& f) {
+        return [this, &f](const auto&... args) {
+          const auto start = std::chrono::steady_clock::now();
+          auto result = f(args...);
+          const auto elapsed = std::chrono::steady_clock::now() - start;
+          calls.fetch_add(1, std::memory_order_relaxed);
+          nanoseconds.fetch_add(std::chrono::duration_cast<
+              std::chrono::nanoseconds>(elapsed).count(),
+              std::memory_order_relaxed);
+          return result;
+        };
+      }
+
+    private:
+
+      // Totals, updated by whichever thread made the call
+      std::atomic<unsigned long> calls{0};
+      std::atomic<unsigned long long> nanoseconds{0};
+  };
+}
+
+#endif
@@ -0,0 +1,38 @@
+// Controller/AStar/StateCodec.h
+// Converts states and actions to and from the keys a search stores
+
+#ifndef CONTROLLER_ASTAR_STATECODEC_H
+#define CONTROLLER_ASTAR_STATECODEC_H
+
+// Seperate functions here from other controllers
+namespace Controller {
+
+  // Stores states and actions exactly as they are given
+  // Other codecs can store something smaller in the same way:
+  // - StateKey and ActionKey are the types kept for every node, and keys
+  //   need == and std::hash
+  // - canEncode says whether every state reachable from a start can be
+  //   encoded, and prepare is given that start before searching from it
+  // - decodeState rebuilds a full state from a key, and is only called on
+  //   states that are about to be expanded
+  // Templates: thought STATE, ACTION
+  template <class S, class A>
+  struct IdentityCodec {
+
+    // Types stored in place of states and actions
+    typedef S StateKey;
+    typedef A ActionKey;
+
+    // Every state can be stored as it is
+    bool canEncode(const S&) const { return true; }
+    void prepare(const S&) {}
+
+    // Convert states and actions
+    const S& encodeState(const S& state) const { return state; }
+    const S& decodeState(const StateKey& key) const { return key; }
+    const A& encodeAction(const A& action) const { return action; }
+    const A& decodeAction(const ActionKey& key) const { return key; }
+  };
+}
+
+#endif
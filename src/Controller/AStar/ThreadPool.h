@@ -0,0 +1,146 @@
+// Controller/AStar/ThreadPool.h
+// A persistent pool of threads for sharing out small loops
+
+#ifndef CONTROLLER_ASTAR_THREADPOOL_H
+#define CONTROLLER_ASTAR_THREADPOOL_H
+
+#include <cstddef>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+// Seperate functions here from other controllers
+namespace Controller {
+
+  // Runs the iterations of a loop across a fixed set of threads
+  // - Threads are created once and sleep between loops
+  // - The calling thread works on the loop too, so a pool of n threads
+  //   only creates n - 1 of its own
+  // - Iterations are handed out one at a time, so uneven work balances out
+  class ThreadPool {
+
+    public:
+
+      // Create a pool that runs loops on the given number of threads
+      explicit ThreadPool(unsigned int threads) {
+        for (unsigned int i = 1; i < threads; ++i) {
+          workers_.emplace_back(&ThreadPool::wait, this);
+        }
+      }
+
+      // Wake every thread and wait for them to finish
+      ~ThreadPool() {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) { worker.join(); }
+      }
+
+      // Pools own their threads so can't be copied
+      ThreadPool(const ThreadPool&) = delete;
+      ThreadPool& operator=(const ThreadPool&) = delete;
+
+      // Number of threads loops are run on, including the caller
+      unsigned int size() const { return workers_.size() + 1; }
+
+      // Call f(i) for every i in [0, count) and wait for all of them
+      // f must be safe to call from several threads at once
+      template <class F>
+      void parallelFor(std::size_t count, const F& f) {
+
+        // Don't bother waking anyone for tiny loops
+        if (workers_.empty() || count < 2) {
+          for (std::size_t i = 0; i < count; ++i) { f(i); }
+          return;
+        }
+
+        // Publish the loop once no thread is still looking at the last one
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          finished_.wait(lock, [this]() { return active_ == 0; });
+          context_ = &f;
+          run_ = [](const void* context, std::size_t i) {
+            (*static_cast<const F*>(context))(i);
+          };
+          count_ = count;
+          done_ = 0;
+          next_ = 0;
+          generation_ += 1;
+        }
+        wake_.notify_all();
+
+        // Help out, then wait for every iteration to be finished
+        work();
+        std::unique_lock<std::mutex> lock(mutex_);
+        finished_.wait(lock, [this]() { return done_ == count_; });
+      }
+
+    private:
+
+      // Threads owned by the pool
+      std::vector<std::thread> workers_;
+
+      // Guards everything below other than next_
+      std::mutex mutex_;
+      std::condition_variable wake_;
+      std::condition_variable finished_;
+
+      // The current loop body and its size
+      const void* context_ = nullptr;
+      void (*run_)(const void*, std::size_t) = nullptr;
+      std::size_t count_ = 0;
+
+      // Next iteration to hand out and the number finished
+      std::atomic<std::size_t> next_{0};
+      std::size_t done_ = 0;
+
+      // Number of threads currently running iterations
+      unsigned int active_ = 0;
+
+      // Changes every loop so sleeping threads know there's work
+      unsigned long generation_ = 0;
+      bool stopping_ = false;
+
+      // Run iterations until there are none left
+      void work() {
+        std::size_t finished = 0;
+        for (std::size_t i = next_++; i < count_; i = next_++) {
+          run_(context_, i);
+          finished += 1;
+        }
+        if (finished > 0) {
+          std::lock_guard<std::mutex> lock(mutex_);
+          done_ += finished;
+        }
+        finished_.notify_all();
+      }
+
+      // Sleep until there's a loop to help with
+      void wait() {
+        unsigned long seen = 0;
+        while (true) {
+          {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this, seen]() {
+              return stopping_ || generation_ != seen;
+            });
+            if (stopping_) { return; }
+            seen = generation_;
+            active_ += 1;
+          }
+          work();
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            active_ -= 1;
+          }
+          finished_.notify_all();
+        }
+      }
+  };
+}
+
+#endif
@@ -0,0 +1,182 @@
+// Controller/AStar/TranspositionTable.h
+// A bounded cache of values keyed by state hashes that outlives searches
+
+#ifndef CONTROLLER_ASTAR_TRANSPOSITIONTABLE_H
+#define CONTROLLER_ASTAR_TRANSPOSITIONTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <type_traits>
+
+// Seperate functions here from other controllers
+namespace Controller {
+
+  // Combine two 64 bit hashes into one
+  inline std::uint64_t mixHash(std::uint64_t a, std::uint64_t b) {
+    std::uint64_t n = a + 0x9e3779b97f4a7c15ull + (b << 6) + (b >> 2);
+    n = (n ^ (n >> 30)) * 0xbf58476d1ce4e5b9ull;
+    n = (n ^ (n >> 27)) * 0x94d049bb133111ebull;
+    return n ^ (n >> 31) ^ b;
+  }
+
+  // Hash the bytes of a plain settings struct, used to notice edits
+  // The struct mustn't have any padding between its members
+  template <class T>
+  std::uint64_t hashSettings(const T& settings) {
+    static_assert(std::is_trivially_copyable<T>::value,
+        "Settings must be plain data to be hashed");
+    std::uint64_t result = 0;
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &settings, sizeof(T));
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+      result = mixHash(result, bytes[i]);
+    }
+    return result;
+  }
+
+  // Remembers values by a 64 bit key, with a fixed number of entries
+  // - Keys are trusted to be strong hashes, so no states are stored
+  // - Entries live in pairs: a new key takes an empty slot, otherwise the
+  //   slot written by the oldest decision, otherwise the second slot
+  // - Every decision should call validate, which starts a new generation
+  //   and forgets everything if the settings values come from have changed
+  // - Safe to use from several threads, as entries are locked in stripes
+  // Templates: stored VALUE
+  template <class V>
+  class TranspositionTable {
+
+    public:
+
+      // Create a table with room for roughly the given number of entries
+      explicit TranspositionTable(std::size_t capacity = 1 << 16) {
+        resize(capacity);
+      }
+
+      // Tables own their locks so can't be copied
+      TranspositionTable(const TranspositionTable&) = delete;
+      TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+      // Public getters
+      std::size_t getCapacity() const { return entries.size(); }
+      unsigned long getLookups() const { return lookups.load(); }
+      unsigned long getHits() const { return hits.load(); }
+      unsigned long getReplacements() const { return replacements.load(); }
+
+      // Change the number of entries, rounded up to a power of two
+      // This forgets everything stored
+      void resize(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity) { size <<= 1; }
+        entries.assign(size, Entry());
+        mask = size - 1;
+        resetStats();
+      }
+
+      // Forget everything stored
+      void clear() {
+        entries.assign(entries.size(), Entry());
+        resetStats();
+      }
+
+      // Start a new decision, forgetting everything if settings have changed
+      void validate(std::uint64_t settingsKey) {
+        if (settingsKey != settings) {
+          settings = settingsKey;
+          clear();
+        }
+        generation += 1;
+      }
+
+      // Look for a value, returning whether it was found
+      bool find(std::uint64_t key, V& value) {
+        lookups.fetch_add(1, std::memory_order_relaxed);
+        const std::size_t slot = key & mask & ~std::size_t(1);
+        std::lock_guard<std::mutex> lock(getLock(slot));
+        for (std::size_t i = slot; i < slot + 2; ++i) {
+          if (entries[i].isUsed && entries[i].key == key) {
+            hits.fetch_add(1, std::memory_order_relaxed);
+            value = entries[i].value;
+            return true;
+          }
+        }
+        return false;
+      }
+
+      // Remember a value, replacing an old one if there's no room
+      void store(std::uint64_t key, const V& value) {
+        const std::size_t slot = key & mask & ~std::size_t(1);
+        std::lock_guard<std::mutex> lock(getLock(slot));
+        std::size_t target = slot + 1;
+        for (std::size_t i = slot; i < slot + 2; ++i) {
+          if (!entries[i].isUsed || entries[i].key == key) {
+            target = i;
+            break;
+          }
+        }
+        Entry& entry = entries[target];
+        if (entry.isUsed && entry.key != key) {
+          if (entries[slot].generation < entry.generation) {
+            target = slot;
+          }
+          replacements.fetch_add(1, std::memory_order_relaxed);
+        }
+        entries[target] = Entry{key, value, generation, true};
+      }
+
+      // Look for a value, working it out and remembering it if it's missing
+      template <class F>
+      V getOrCompute(std::uint64_t key, const F& compute) {
+        V value;
+        if (!find(key, value)) {
+          value = compute();
+          store(key, value);
+        }
+        return value;
+      }
+
+    private:
+
+      // A remembered value and the decision it was written in
+      struct Entry {
+        std::uint64_t key = 0;
+        V value = V();
+        std::uint32_t generation = 0;
+        bool isUsed = false;
+      };
+
+      // Storage, always a power of two in size
+      std::vector<Entry> entries;
+      std::size_t mask = 0;
+
+      // Each lock guards every 64th pair of entries
+      std::array<std::mutex, 64> locks;
+
+      // Current decision and the settings values were worked out with
+      std::uint32_t generation = 0;
+      std::uint64_t settings = 0;
+
+      // Keep track of how useful the table is
+      std::atomic<unsigned long> lookups{0};
+      std::atomic<unsigned long> hits{0};
+      std::atomic<unsigned long> replacements{0};
+
+      // Get the lock guarding a pair of entries
+      std::mutex& getLock(std::size_t slot) {
+        return locks[(slot >> 1) & (locks.size() - 1)];
+      }
+
+      // Start counting from scratch
+      void resetStats() {
+        lookups = 0;
+        hits = 0;
+        replacements = 0;
+      }
+  };
+}
+
+#endif
@@ -6,6 +6,9 @@
 
 // Keep dependencies to a minimum
 #include <string>
+#include <atomic>
+#include <memory>
+#include <climits>
 
 // Encapsulate controller types and functions
 namespace Controller {
@@ -13,7 +16,7 @@ namespace Controller {
   // Type of controller
   static const char* typeList[] = {
       "Human", "Idle", "Random", "AStarOne", "AStarTwo", "AStarThree",
-      "AStarFour"};
+      "AStarFour", "BeamOne", "BeamTwo", "BeamThree", "BeamFour"};
   enum class Type {
     Human,
     Idle,
@@ -22,13 +25,121 @@ namespace Controller {
     AStarTwo,
     AStarThree,
     AStarFour,
+    BeamOne,
+    BeamTwo,
+    BeamThree,
+    BeamFour,
     COUNT
   };
 
+  // Number of controllers at the start of the list that every game can use
+  // Beam controllers come after them as only strategy has beam cases
+  static const int sharedTypeCount = (int)Type::BeamOne;
+
   // Convert controller enum to string
   inline std::string typeToString(const Controller::Type& controller) {
     return typeList[(int)controller];
   }
+
+  // Limits on how much work a search may do before it must decide
+  // A limit of 0 means unlimited
+  struct Budget {
+
+    // Maximum number of states to expand
+    unsigned int maxExpansions = 0;
+
+    // Maximum time to spend searching, in milliseconds
+    unsigned int maxMilliseconds = 0;
+
+    // Maximum number of states to keep in memory
+    unsigned int maxNodes = 0;
+
+    // Check whether any limit is in place
+    bool isLimited() const {
+      return maxExpansions > 0 || maxMilliseconds > 0 || maxNodes > 0;
+    }
+  };
+
+  // Add or scale parts of a cost, stopping at the largest value rather than
+  // wrapping around to a small one
+  // Weighted and focal searches scale costs by the weight's numerator and
+  // denominator, so this keeps large costs in order
+  inline unsigned int saturatingAdd(unsigned int a, unsigned int b) {
+    return a > UINT_MAX - b ? UINT_MAX : a + b;
+  }
+  inline unsigned int saturatingMultiply(unsigned int a, unsigned int m) {
+    return m != 0 && a > UINT_MAX / m ? UINT_MAX : a * m;
+  }
+
+  // How far a search may stray from the cheapest plan to finish sooner
+  struct Suboptimality {
+
+    // Optimal searches by f = g + h
+    // Weighted searches by f = g + w * h
+    // Focal expands the lowest h among states with f <= w * lowest f
+    enum class Mode { Optimal, Weighted, Focal };
+    Mode mode = Mode::Optimal;
+
+    // The weight w, kept as a fraction so any scalable cost can use it
+    unsigned int numerator = 1;
+    unsigned int denominator = 1;
+  };
+
+  // How A* chooses between open states with the same f
+  // - Oldest first expands states in the order they were found
+  // - Higher g prefers states further from the start, as with a zero
+  //   heuristic they're more likely to be close to a goal
+  // - Newest first expands the most recently found or improved state
+  // - Deeper prefers states reached with more actions
+  // - User key prefers the lowest value of a key given with the search
+  static const char* tieBreakList[] = {
+      "Oldest first", "Higher g", "Newest first", "Deeper", "User key"};
+  enum class TieBreak {
+    Oldest,
+    HigherG,
+    Newest,
+    Deeper,
+    UserKey,
+    COUNT
+  };
+
+  // Search algorithm used to make a decision
+  // IDA* and SMA* keep memory use down on large maps
+  // Beam search keeps decision time down by only keeping the best states
+  static const char* algorithmList[] = {
+      "A*", "Parallel A*", "IDA*", "SMA*", "Beam search"};
+  enum class Algorithm {
+    AStar,
+    ParallelAStar,
+    IDAStar,
+    SMAStar,
+    BeamSearch,
+    COUNT
+  };
+
+  // Lets another thread ask a search to stop as soon as possible
+  // Copies share the same flag, so keep one and hand a copy to the search
+  class StopToken {
+    public:
+
+      // Every new token starts unstopped
+      StopToken() : stopped_(std::make_shared<std::atomic<bool>>(false)) {}
+
+      // Ask anything holding this token to stop
+      void requestStop() const { 
+        stopped_->store(true, std::memory_order_relaxed); 
+      }
+
+      // Check whether a stop has been requested
+      bool isStopRequested() const { 
+        return stopped_->load(std::memory_order_relaxed); 
+      }
+
+    private:
+
+      // Flag shared between all copies of the token
+      std::shared_ptr<std::atomic<bool>> stopped_;
+  };
 }
 
 #endif
@@ -6,6 +6,16 @@
 
 #include <utility>
 #include <stack>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <chrono>
+#include "../../../Controller/Common.h"
+#include "../../../Controller/AStar/TranspositionTable.h"
+#include "../../../Controller/AStar/SearchStats.h"
+#include "../../../Controller/AStar/SearchLog.h"
 #include "../Action.h"
 #include "../GameState.h"
 
@@ -25,12 +35,229 @@ namespace Strategy::AI {
       // Cases must allow for getting the amount of open states
       virtual const unsigned int getOpenStatesRemaining() const = 0;
 
+      // Cases must allow for getting the amount of closed states
+      virtual const unsigned int getClosedStates() const = 0;
+
+      // Cases must allow for getting closed set lookups and probes
+      virtual std::pair<unsigned long, unsigned long> 
+          getClosedSetProbes() const = 0;
+
+      // Cases must allow for getting cost cache lookups and hits
+      virtual std::pair<unsigned long, unsigned long> 
+          getCacheHits() const = 0;
+
+      // Cases must allow for getting measurements of the last search
+      virtual Controller::SearchStats getSearchStats() const = 0;
+
+      // Cases must report whether the last decision ran out of budget
+      virtual const bool wasBudgetExhausted() const = 0;
+
+      // Cases must be able to free the memory held by their last search
+      virtual void release() = 0;
+
       // Optional function for adding additional debugging
       virtual void debug() {}
 
+      // Record the states expanded by future decisions, A* only
+      bool isRecordingSearch() const { return isRecording; }
+      void setRecordingSearch(bool enable) { isRecording = enable; }
+
+      // Time the callables of future decisions, A* only
+      bool isTimingSearch() const { return isTiming; }
+      void setTimingSearch(bool enable) { isTiming = enable; }
+
+      // The states expanded by the last recorded decision
+      // The context holds the selection the decision started with
+      const Controller::SearchLog<Action>& getSearchLog() const { 
+        return searchLog; 
+      }
+
+      // How long a parallel A* decision took with some number of threads
+      struct ThreadTiming {
+        unsigned int threads;
+        double milliseconds;
+        unsigned int statesProcessed;
+      };
+
+      // Time a decision with parallel A* on 1, 2, 4... up to maxThreads
+      // Every other setting is kept, and the decisions are thrown away
+      // Stops between decisions when asked to, keeping the timings so far
+      std::vector<ThreadTiming> timeThreads(
+          const GameState& state, 
+          unsigned int maxThreads,
+          const Controller::StopToken& stop) {
+        const auto oldAlgorithm = algorithm;
+        const auto oldThreads = threads;
+        algorithm = Controller::Algorithm::ParallelAStar;
+        std::vector<ThreadTiming> timings;
+        for (unsigned int n = 1; n <= maxThreads; n *= 2) {
+          threads = n;
+          const auto start = std::chrono::steady_clock::now();
+          (*this)(state, stop);
+          if (stop.isStopRequested()) { break; }
+          timings.push_back(ThreadTiming{n, 
+              std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - start).count(),
+              getStatesProcessed()});
+        }
+        algorithm = oldAlgorithm;
+        threads = oldThreads;
+        return timings;
+      }
+
+      // Allow the search algorithm and budget to be customised
+      void debugBudget() {
+        ImGui::PushItemWidth(120.f);
+        ImGui::Combo("Algorithm", (int*)&algorithm, 
+            Controller::algorithmList, (int)Controller::Algorithm::COUNT);
+        ImGui::PopItemWidth();
+        ImGui::PushItemWidth(80.f);
+        ImGui::Text("Search budget (0 is unlimited):");
+        ImGui::InputInt("Max expansions", 
+            (int*)&budget.maxExpansions, 0, 1000);
+        ImGui::InputInt("Max milliseconds", 
+            (int*)&budget.maxMilliseconds, 0, 100);
+        ImGui::InputInt("Max nodes in memory", 
+            (int*)&budget.maxNodes, 0, 1000);
+        if (algorithm == Controller::Algorithm::SMAStar) {
+          ImGui::Text("SMA* forgets states rather than stopping at the limit");
+        }
+        else if (algorithm == Controller::Algorithm::IDAStar) {
+          ImGui::Text("IDA* limits its table of seen states to the limit,"
+              " and never above 65536");
+        }
+        if (algorithm == Controller::Algorithm::BeamSearch) {
+          ImGui::Text("States kept at each depth:");
+          ImGui::InputInt("Beam width", (int*)&beamWidth, 1, 16);
+          if ((int)beamWidth < 1) { beamWidth = 1; }
+        }
+        if (algorithm == Controller::Algorithm::ParallelAStar) {
+          ImGui::Text("Search threads:");
+          ImGui::InputInt("Threads", (int*)&threads, 1, 1);
+          if ((int)threads < 1) { threads = 1; }
+        }
+        if (algorithm == Controller::Algorithm::AStar) {
+          ImGui::Text("Successor threads:");
+          ImGui::InputInt("Successor threads", (int*)&successorThreads, 1, 1);
+          if ((int)successorThreads < 1) { successorThreads = 1; }
+          ImGui::Checkbox("Pack stored states", &isPackingStates);
+        }
+        ImGui::PopItemWidth();
+      }
+
+      // Allow speed to be traded for plan cost
+      void debugSuboptimality() {
+        if (algorithm != Controller::Algorithm::AStar) { return; }
+        static const char* modes[] = {"Optimal", "Weighted A*", "Focal"};
+        ImGui::PushItemWidth(120.f);
+        ImGui::Text("Search mode (weight is w in g + w * h, or the bound):");
+        ImGui::Combo("Mode", (int*)&suboptimality.mode, 
+            modes, IM_ARRAYSIZE(modes));
+        if (suboptimality.mode != Controller::Suboptimality::Mode::Optimal) {
+          float weight = (float)suboptimality.numerator / 
+              suboptimality.denominator;
+          ImGui::SliderFloat("Weight", &weight, 1.f, 5.f, "%.2f");
+          suboptimality.numerator = std::max(100u, 
+              (unsigned int)std::lround(weight * 100.f));
+          suboptimality.denominator = 100;
+        }
+        if (suboptimality.mode != Controller::Suboptimality::Mode::Focal) {
+          ImGui::Text("Order of states with equal cost (user key is the"
+              " fewest points left):");
+          ImGui::Combo("Tie-breaking", (int*)&tieBreak, 
+              Controller::tieBreakList, (int)Controller::TieBreak::COUNT);
+        }
+        ImGui::PopItemWidth();
+      }
+
       // All cases use the () operator as they're functors
+      // The search should give up when the token is stopped
       virtual std::pair<bool, std::stack<Strategy::Action>> 
-          operator()(const GameState&) = 0;
+          operator()(const GameState&, const Controller::StopToken&) = 0;
+
+    protected:
+
+      // Pass the case's settings on to a pathfinder before a decision
+      // The turn is ended if the budget runs out
+      // Costs are turned into a single number with score when recording
+      template <class P, class Score>
+      void configure(
+          P& pathfinder, 
+          const GameState& state, 
+          const Controller::StopToken& stop,
+          const Score& score) {
+        pathfinder.setAlgorithm(algorithm);
+        pathfinder.setPacking(isPackingStates);
+        pathfinder.setBudget(budget);
+        pathfinder.setCompletion({ Action(Action::Tag::EndTurn) });
+        pathfinder.setStopToken(stop);
+        pathfinder.setThreads(threads);
+        pathfinder.setSuccessorThreads(successorThreads);
+        pathfinder.setSuboptimality(suboptimality);
+        pathfinder.setBeamWidth(beamWidth);
+        pathfinder.setTieBreak(tieBreak);
+        pathfinder.setTieBreakKey(getPointsLeft);
+        pathfinder.setTimingCallbacks(isTiming);
+        searchLog.clear();
+        if (isRecording) {
+          searchLog.setContext(std::to_string(state.selection.x) + " " 
+              + std::to_string(state.selection.y));
+          pathfinder.setSearchLog(&searchLog, score);
+        }
+        else {
+          pathfinder.setSearchLog(nullptr, score);
+        }
+      }
+
+      // Secondary key for tie-breaking, preferring states that have used
+      // more of the turn's movement and action points
+      static unsigned long getPointsLeft(const GameState& state) {
+        return (unsigned long)std::max(state.remainingMP, 0) 
+            + (unsigned long)std::max(state.remainingAP, 0);
+      }
+
+      // Key for remembering the cost of an action between decisions
+      static std::uint64_t hashAction(
+          const GameState& from, 
+          const GameState& to, 
+          const Action& action) {
+        std::uint64_t key = Controller::mixHash(hashState(from), hashState(to));
+        key = Controller::mixHash(key, action.tag);
+        return Controller::mixHash(key, 
+            ((std::uint64_t)(std::uint32_t)action.location.x << 32) 
+            | (std::uint32_t)action.location.y);
+      }
+
+      // Search algorithm to decide with
+      Controller::Algorithm algorithm = Controller::Algorithm::AStar;
+
+      // Limits on how long the case may think for
+      Controller::Budget budget;
+
+      // How far the serial search may stray from the cheapest plan
+      Controller::Suboptimality suboptimality;
+
+      // How the serial search orders states with equal cost
+      Controller::TieBreak tieBreak = Controller::TieBreak::Oldest;
+
+      // Threads to search with when using parallel A*
+      unsigned int threads = 2;
+
+      // Threads to score each expanded state's neighbours with
+      unsigned int successorThreads = 1;
+
+      // Whether A* stores states in their packed form where it can
+      bool isPackingStates = false;
+
+      // States kept at each depth when using beam search
+      unsigned int beamWidth = 16;
+
+      // Whether the callables of decisions are timed
+      bool isTiming = false;
+
+      // Whether decisions are recorded, and the last one recorded
+      bool isRecording = false;
+      Controller::SearchLog<Action> searchLog;
   };
 }
 
@@ -0,0 +1,25 @@
+// Strategy/AI/Beam.h
+// A case study that decides with beam search from the start
+
+#ifndef STRATEGY_AI_BEAM_H
+#define STRATEGY_AI_BEAM_H
+
+#include "BaseCase.h"
+
+// Encapsulate all strategy AIs
+namespace Strategy::AI {
+
+  // Wraps any case study, using its costs to rank states for beam search
+  // The algorithm and width can still be changed in the AI Viewer
+  template <class Case>
+  class Beam : public Case {
+    public:
+
+      // Start off using beam search
+      Beam() {
+        this->algorithm = Controller::Algorithm::BeamSearch;
+      }
+  };
+}
+
+#endif
@@ -9,13 +9,15 @@
 
 // Start making the decision
 std::pair<bool, std::stack<Strategy::Action>> 
-Strategy::AI::CaseFour::operator()(const GameState& state) {
+Strategy::AI::CaseFour::operator()(
+    const GameState& state, 
+    const Controller::StopToken& stop) {
 
   // Save starting state
   startingState = state;
 
   // Count allies and enemies
-  const auto& counts = Game::countTeams(state.map);
+  const auto& counts = state.teams;
   startingAlliesInRange = 0;
   startingEnemiesInRange = 0;
 
@@ -39,23 +41,37 @@ Strategy::AI::CaseFour::operator()(const GameState& state) {
   startingAllyCount = inRange.first;
   startingEnemyCount = inRange.second;
 
-  // Perform decision
-  return astar(
+  // Forget remembered costs if the penalties or goals have changed
+  // Costs depend on the starting state too, so it's part of every key
+  const std::uint64_t settings = Controller::mixHash(Controller::mixHash(
+      Controller::hashSettings(penalties), 
+      Controller::hashSettings(predictions)), enableGoalMoveOrKill);
+  weightTable.validate(settings);
+  heuristicTable.validate(settings);
+  const std::uint64_t startKey = hashState(state);
+
+  // Perform decision, ending the turn if the budget runs out
+  configure(pathfinder, state, stop, 
+      [](const Cost& c) { return (float)c.value; });
+  return pathfinder(
       state, 
       minimumCost, 
       maximumCost, 
-      std::bind(&CaseFour::getActions, this,
-        std::placeholders::_1),
-      std::bind(&CaseFour::isStateEndpoint, this,
-        std::placeholders::_1,
-        std::placeholders::_2),
-      std::bind(&CaseFour::heuristic, this,
-        std::placeholders::_1),
-      std::bind(&CaseFour::weighAction, this,
-        std::placeholders::_1,
-        std::placeholders::_2,
-        std::placeholders::_3,
-        std::placeholders::_4),
+      [this](const GameState& s) { return getActions(s); },
+      [this](const GameState& a, const GameState& b) { 
+        return isStateEndpoint(a, b); 
+      },
+      [this, startKey](const GameState& s) { 
+        return heuristicTable.getOrCompute(
+            Controller::mixHash(startKey, hashState(s)), 
+            [&]() { return heuristic(s); });
+      },
+      [this, startKey](const GameState& start, const GameState& from, 
+          const GameState& to, const Action& action) {
+        return weightTable.getOrCompute(
+            Controller::mixHash(startKey, hashAction(from, to, action)), 
+            [&]() { return weighAction(start, from, to, action); });
+      },
       Game::takeAction,
       std::less<Cost>());
 }
@@ -63,19 +79,55 @@ Strategy::AI::CaseFour::operator()(const GameState& state) {
 // Get number of states processed so far
 const unsigned int
 Strategy::AI::CaseFour::getStatesProcessed() const {
-  return astar.getStatesProcessed();
+  return pathfinder.getStatesProcessed();
 }
 
 // Get number of open states remaining
 const unsigned int
 Strategy::AI::CaseFour::getOpenStatesRemaining() const {
-  return astar.getRemaining().size();
+  return pathfinder.getOpenCount();
+}
+
+// Get number of closed states
+const unsigned int
+Strategy::AI::CaseFour::getClosedStates() const {
+  return pathfinder.getClosedCount();
+}
+
+// Get number of lookups and probes made in the closed set
+std::pair<unsigned long, unsigned long>
+Strategy::AI::CaseFour::getClosedSetProbes() const {
+  return std::make_pair(pathfinder.getLookups(), pathfinder.getProbes());
+}
+
+// Get number of lookups and hits made in the cost cache
+std::pair<unsigned long, unsigned long>
+Strategy::AI::CaseFour::getCacheHits() const {
+  return std::make_pair(weightTable.getLookups() + heuristicTable.getLookups(), weightTable.getHits() + heuristicTable.getHits());
+}
+
+// Get measurements of the last search
+Controller::SearchStats
+Strategy::AI::CaseFour::getSearchStats() const {
+  return pathfinder.getStats();
+}
+
+// Check whether the last decision ran out of budget
+const bool
+Strategy::AI::CaseFour::wasBudgetExhausted() const {
+  return pathfinder.getBudgetExhausted();
+}
+
+// Free the memory held by the last decision
+void
+Strategy::AI::CaseFour::release() {
+  pathfinder.release();
 }
 
 // Debugging functionality
 void
 Strategy::AI::CaseFour::debug() {
-  const auto& actionAndCost = astar.getCurrentAction();
+  const auto& actionAndCost = pathfinder.getCurrentAction();
   ImGui::Columns(2);
   ImGui::Text("%s (%d, %d)",
       actionToString(actionAndCost.first),
@@ -86,12 +138,13 @@ Strategy::AI::CaseFour::debug() {
       actionAndCost.second.value);
   ImGui::Columns(1);
   Cost totalCost = minimumCost;
-  const auto& fScores = astar.getFScores();
-  for (const auto& kvp : fScores) {
-    totalCost = totalCost + kvp.second;
-  }
+  std::size_t nodes = 0;
+  pathfinder.forEachNode([&](const auto& node) {
+    totalCost = totalCost + node.f;
+    nodes += 1;
+  });
   ImGui::Text("Average cost: %f", 
-      (float)totalCost.value / fScores.size());
+      (float)totalCost.value / nodes);
   ImGui::Spacing(); ImGui::Spacing();
   ImGui::PushItemWidth(30.f);
   ImGui::Text("Goal customisation:");
@@ -159,7 +212,7 @@ Strategy::AI::CaseFour::isStateEndpoint(
   if (enableGoalMoveOrKill) {
 
     // Count allies and enemies
-    const auto& prevCounts = Game::countTeams(a.map);
+    const auto& prevCounts = a.teams;
     unsigned int previousEnemyCount = 0;
 
     // Sum the counts of the other teams into the enemy count
@@ -170,7 +223,7 @@ Strategy::AI::CaseFour::isStateEndpoint(
     }
 
     // Count allies and enemies
-    const auto& counts = Game::countTeams(b.map);
+    const auto& counts = b.teams;
     unsigned int enemyCount = 0;
 
     // Sum the counts of the other teams into the enemy count
@@ -244,7 +297,7 @@ Strategy::AI::CaseFour::heuristic(const GameState& state) {
 
     // Count number of enemies
     unsigned int enemyCount = 0;
-    const auto& teams = Game::countTeams(state.map);
+    const auto& teams = state.teams;
     for (const auto& kvp : teams) {
       if (kvp.first != startingState.currentTeam) {
         enemyCount += kvp.second;
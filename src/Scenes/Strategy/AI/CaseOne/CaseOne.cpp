@@ -9,15 +9,28 @@
 
 // Start making the decision
 std::pair<bool, std::stack<Strategy::Action>> 
-Strategy::AI::CaseOne::operator()(const GameState& state) {
-  return astar(
+Strategy::AI::CaseOne::operator()(
+    const GameState& state, 
+    const Controller::StopToken& stop) {
+
+  // Forget remembered costs if the personality has changed
+  weightTable.validate(Controller::hashSettings(personality));
+
+  // Perform decision, ending the turn if the budget runs out
+  configure(pathfinder, state, stop, 
+      [this](const Cost& c) { return personality.score(c); });
+  return pathfinder(
       state, 
       minimumCost, 
       maximumCost, 
       Game::getAllPossibleActions,
       isStateEndpoint,
       heuristic,
-      weighAction,
+      [this](const GameState& start, const GameState& from, 
+          const GameState& to, const Action& action) {
+        return weightTable.getOrCompute(hashAction(from, to, action), 
+            [&]() { return weighAction(start, from, to, action); });
+      },
       Game::takeAction,
       personality);
 }
@@ -25,13 +38,49 @@ Strategy::AI::CaseOne::operator()(const GameState& state) {
 // Get number of states processed so far
 const unsigned int
 Strategy::AI::CaseOne::getStatesProcessed() const {
-  return astar.getStatesProcessed();
+  return pathfinder.getStatesProcessed();
 }
 
 // Get number of open states remaining
 const unsigned int
 Strategy::AI::CaseOne::getOpenStatesRemaining() const {
-  return astar.getRemaining().size();
+  return pathfinder.getOpenCount();
+}
+
+// Get number of closed states
+const unsigned int
+Strategy::AI::CaseOne::getClosedStates() const {
+  return pathfinder.getClosedCount();
+}
+
+// Get number of lookups and probes made in the closed set
+std::pair<unsigned long, unsigned long>
+Strategy::AI::CaseOne::getClosedSetProbes() const {
+  return std::make_pair(pathfinder.getLookups(), pathfinder.getProbes());
+}
+
+// Get number of lookups and hits made in the cost cache
+std::pair<unsigned long, unsigned long>
+Strategy::AI::CaseOne::getCacheHits() const {
+  return std::make_pair(weightTable.getLookups(), weightTable.getHits());
+}
+
+// Get measurements of the last search
+Controller::SearchStats
+Strategy::AI::CaseOne::getSearchStats() const {
+  return pathfinder.getStats();
+}
+
+// Check whether the last decision ran out of budget
+const bool
+Strategy::AI::CaseOne::wasBudgetExhausted() const {
+  return pathfinder.getBudgetExhausted();
+}
+
+// Free the memory held by the last decision
+void
+Strategy::AI::CaseOne::release() {
+  pathfinder.release();
 }
 
 // Debugging functionality
@@ -103,31 +152,26 @@ Strategy::AI::CaseOne::weighAction(
 
   // Check to see if there are allies within the range of enemies
   // - This will allow the AI to prioritise moving allies out of range / sight
-  for (const auto& object : to.map.field) {
-
-    // Only iterate through allied units
-    const auto& pos = Game::indexToCoord(to.map, object.first);
-    const auto& unit = object.second;
-    if (unit.first == team && isUnit(unit.second)) {
-
-      // Check to see if any enemies are in sight
-      const auto& enemies = Game::getUnitsInSight(to.map, pos);
-
-      // Check to see if the ally is in range of an enemy
-      bool inEnemyRange = false;
-      for (unsigned int i = 0; !inEnemyRange && i < enemies.size(); ++i) {
-        const auto& enemyAndDistance = enemies[i];
-        const auto& object = Game::readMap(to.map, enemyAndDistance.first);
-        const auto& range = getUnitRange(object.second);
-
-        // If the ally is in range of an enemy, record it 
-        if (enemyAndDistance.second <= range) {
-          inEnemyRange = true;
-          cost.alliesAtRiskPenalty += 1;
-        }
+  to.map.field.getTeamUnits(team).forEach([&](std::size_t index) {
+
+    // Check to see if any enemies are in sight
+    const auto& pos = Game::indexToCoord(to.map, index);
+    const auto& enemies = Game::getUnitsInSight(to.map, pos);
+
+    // Check to see if the ally is in range of an enemy
+    bool inEnemyRange = false;
+    for (unsigned int i = 0; !inEnemyRange && i < enemies.size(); ++i) {
+      const auto& enemyAndDistance = enemies[i];
+      const auto& object = Game::readMap(to.map, enemyAndDistance.first);
+      const auto& range = getUnitRange(object.second);
+
+      // If the ally is in range of an enemy, record it 
+      if (enemyAndDistance.second <= range) {
+        inEnemyRange = true;
+        cost.alliesAtRiskPenalty += 1;
       }
     }
-  }
+  });
 
   // Return the calculated cost of this action
   return cost;
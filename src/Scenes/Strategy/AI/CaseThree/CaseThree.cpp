@@ -9,22 +9,33 @@
 
 // Start making the decision
 std::pair<bool, std::stack<Strategy::Action>> 
-Strategy::AI::CaseThree::operator()(const GameState& state) {
-  return astar(
+Strategy::AI::CaseThree::operator()(
+    const GameState& state, 
+    const Controller::StopToken& stop) {
+
+  // Forget remembered costs if the penalties have changed
+  // Costs depend on the starting state too, so it's part of every key
+  weightTable.validate(Controller::hashSettings(penalties));
+  const std::uint64_t startKey = hashState(state);
+
+  // Perform decision, ending the turn if the budget runs out
+  configure(pathfinder, state, stop, 
+      [](const Cost& c) { return (float)c.value; });
+  return pathfinder(
       state, 
       minimumCost, 
       maximumCost, 
       Game::getAllPossibleActions,
-      std::bind(&CaseThree::isStateEndpoint, this, 
-          std::placeholders::_1,
-          std::placeholders::_2),
-      std::bind(&CaseThree::heuristic, this,
-        std::placeholders::_1),
-      std::bind(&CaseThree::weighAction, this,
-        std::placeholders::_1,
-        std::placeholders::_2,
-        std::placeholders::_3,
-        std::placeholders::_4),
+      [this](const GameState& a, const GameState& b) { 
+        return isStateEndpoint(a, b); 
+      },
+      [this](const GameState& s) { return heuristic(s); },
+      [this, startKey](const GameState& start, const GameState& from, 
+          const GameState& to, const Action& action) {
+        return weightTable.getOrCompute(
+            Controller::mixHash(startKey, hashAction(from, to, action)), 
+            [&]() { return weighAction(start, from, to, action); });
+      },
       Game::takeAction,
       std::less<Cost>());
 }
@@ -32,19 +43,55 @@ Strategy::AI::CaseThree::operator()(const GameState& state) {
 // Get number of states processed so far
 const unsigned int
 Strategy::AI::CaseThree::getStatesProcessed() const {
-  return astar.getStatesProcessed();
+  return pathfinder.getStatesProcessed();
 }
 
 // Get number of open states remaining
 const unsigned int
 Strategy::AI::CaseThree::getOpenStatesRemaining() const {
-  return astar.getRemaining().size();
+  return pathfinder.getOpenCount();
+}
+
+// Get number of closed states
+const unsigned int
+Strategy::AI::CaseThree::getClosedStates() const {
+  return pathfinder.getClosedCount();
+}
+
+// Get number of lookups and probes made in the closed set
+std::pair<unsigned long, unsigned long>
+Strategy::AI::CaseThree::getClosedSetProbes() const {
+  return std::make_pair(pathfinder.getLookups(), pathfinder.getProbes());
+}
+
+// Get number of lookups and hits made in the cost cache
+std::pair<unsigned long, unsigned long>
+Strategy::AI::CaseThree::getCacheHits() const {
+  return std::make_pair(weightTable.getLookups(), weightTable.getHits());
+}
+
+// Get measurements of the last search
+Controller::SearchStats
+Strategy::AI::CaseThree::getSearchStats() const {
+  return pathfinder.getStats();
+}
+
+// Check whether the last decision ran out of budget
+const bool
+Strategy::AI::CaseThree::wasBudgetExhausted() const {
+  return pathfinder.getBudgetExhausted();
+}
+
+// Free the memory held by the last decision
+void
+Strategy::AI::CaseThree::release() {
+  pathfinder.release();
 }
 
 // Debugging functionality
 void
 Strategy::AI::CaseThree::debug() {
-  const auto& actionAndCost = astar.getCurrentAction();
+  const auto& actionAndCost = pathfinder.getCurrentAction();
   ImGui::Columns(2);
   ImGui::Text("%s (%d, %d)",
       actionToString(actionAndCost.first),
@@ -55,12 +102,13 @@ Strategy::AI::CaseThree::debug() {
       actionAndCost.second.value);
   ImGui::Columns(1);
   Cost totalCost = minimumCost;
-  const auto& fScores = astar.getFScores();
-  for (const auto& kvp : fScores) {
-    totalCost = totalCost + kvp.second;
-  }
+  std::size_t nodes = 0;
+  pathfinder.forEachNode([&](const auto& node) {
+    totalCost = totalCost + node.f;
+    nodes += 1;
+  });
   ImGui::Text("Average cost: %f", 
-      (float)totalCost.value / fScores.size());
+      (float)totalCost.value / nodes);
   ImGui::Spacing(); ImGui::Spacing();
   ImGui::PushItemWidth(30.f);
   ImGui::Text("Penalty customisation:");
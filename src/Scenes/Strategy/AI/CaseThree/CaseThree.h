@@ -5,8 +5,9 @@
 #define CASETHREE_H
 
 #include <utility>
-#include "../../../../Controller/AStar/AStar.h"
+#include "../../../../Controller/AStar/Pathfinder.h"
 #include "../../Strategy.h"
+#include "../../PackedState.h"
 #include "../BaseCase.h"
 
 // Encapsulate Strategy AIs
@@ -17,11 +18,21 @@ namespace Strategy::AI {
     public:
 
       // Process the decision
-      std::pair<bool, std::stack<Action>> operator()(const GameState& state);
+      std::pair<bool, std::stack<Action>> operator()(
+          const GameState& state, 
+          const Controller::StopToken& stop);
 
       // Debugging functions
       const unsigned int getStatesProcessed() const override;
       const unsigned int getOpenStatesRemaining() const override;
+      const unsigned int getClosedStates() const override;
+      std::pair<unsigned long, unsigned long> 
+          getClosedSetProbes() const override;
+      std::pair<unsigned long, unsigned long> 
+          getCacheHits() const override;
+      Controller::SearchStats getSearchStats() const override;
+      const bool wasBudgetExhausted() const override;
+      void release() override;
       void debug() override;
 
       // Store values to help evaluate the cost of taking an Action
@@ -52,8 +63,12 @@ namespace Strategy::AI {
         unsigned int value = 0;
 
         // Operators
-        Cost operator+(const Cost& c) const { return Cost { value + c.value }; }
-        Cost operator*(unsigned int m) const { return Cost { value * m }; }
+        Cost operator+(const Cost& c) const { 
+          return Cost { Controller::saturatingAdd(value, c.value) }; 
+        }
+        Cost operator*(unsigned int m) const { 
+          return Cost { Controller::saturatingMultiply(value, m) }; 
+        }
         bool operator<(const Cost& c) const { return value < c.value; }
         bool operator==(const Cost& c) const { return value == c.value; }
 
@@ -61,8 +76,11 @@ namespace Strategy::AI {
 
     private:
 
-      // Store an A* functor
-      Controller::AStar<GameState, Action, Cost> astar;
+      // Store an A* functor for each variant of A*
+      Controller::Pathfinder<GameState, Action, Cost, PackedCodec> pathfinder;
+
+      // Remember the cost of actions between decisions
+      Controller::TranspositionTable<Cost> weightTable;
 
       // Store values for giving penalties
       Cost::Penalty penalties;
@@ -5,8 +5,9 @@
 #define CASETWO_H
 
 #include <utility>
-#include "../../../../Controller/AStar/AStar.h"
+#include "../../../../Controller/AStar/Pathfinder.h"
 #include "../../Strategy.h"
+#include "../../PackedState.h"
 #include "../BaseCase.h"
 
 // Encapsulate Strategy AIs
@@ -18,11 +19,21 @@ namespace Strategy::AI {
 
       // Process the decision
       std::pair<bool, std::stack<Action>> 
-          operator()(const GameState& state) override;
+          operator()(
+              const GameState& state, 
+              const Controller::StopToken& stop) override;
 
       // Debugging functions
       const unsigned int getStatesProcessed() const override;
       const unsigned int getOpenStatesRemaining() const override;
+      const unsigned int getClosedStates() const override;
+      std::pair<unsigned long, unsigned long> 
+          getClosedSetProbes() const override;
+      std::pair<unsigned long, unsigned long> 
+          getCacheHits() const override;
+      Controller::SearchStats getSearchStats() const override;
+      const bool wasBudgetExhausted() const override;
+      void release() override;
       void debug() override;
 
       // Store values to help evaluate the cost of taking an Action
@@ -45,22 +56,24 @@ namespace Strategy::AI {
         // Combine Costs by adding their components
         inline Cost operator+ (const Cost& c) const {
           return Cost{
-            remainingEnemyPenalty + c.remainingEnemyPenalty,
-            lostAlliesPenalty + c.lostAlliesPenalty,
-            alliesAtRiskPenalty + c.alliesAtRiskPenalty,
-            unusedMPPenalty + c.unusedMPPenalty,
-            unusedAPPenalty + c.unusedAPPenalty,
+            Controller::saturatingAdd(
+                remainingEnemyPenalty, c.remainingEnemyPenalty),
+            Controller::saturatingAdd(lostAlliesPenalty, c.lostAlliesPenalty),
+            Controller::saturatingAdd(
+                alliesAtRiskPenalty, c.alliesAtRiskPenalty),
+            Controller::saturatingAdd(unusedMPPenalty, c.unusedMPPenalty),
+            Controller::saturatingAdd(unusedAPPenalty, c.unusedAPPenalty),
           };
         }
 
         // Allow a cost to be scaled
         inline Cost operator* (unsigned int m) const {
           return Cost{
-            remainingEnemyPenalty * m,
-            lostAlliesPenalty * m,
-            alliesAtRiskPenalty * m,
-            unusedMPPenalty * m,
-            unusedAPPenalty * m
+            Controller::saturatingMultiply(remainingEnemyPenalty, m),
+            Controller::saturatingMultiply(lostAlliesPenalty, m),
+            Controller::saturatingMultiply(alliesAtRiskPenalty, m),
+            Controller::saturatingMultiply(unusedMPPenalty, m),
+            Controller::saturatingMultiply(unusedAPPenalty, m)
           };
         }
       };
@@ -75,33 +88,29 @@ namespace Strategy::AI {
       float unusedMPMultiplier = 5.f;
       float unusedAPMultiplier = 5.f;
 
+      // Use personality's preferences to modify 'true' values
+      // This allows the AI to ignore or prioritise things
+      constexpr float score(const Cost& c) const {
+        return c.remainingEnemyPenalty * remainingEnemyMultiplier +
+            c.lostAlliesPenalty * lostAlliesMultiplier +
+            c.alliesAtRiskPenalty * alliesAtRiskMultiplier +
+            c.unusedMPPenalty * unusedMPMultiplier +
+            c.unusedAPPenalty * unusedAPMultiplier;
+      }
+
       // Ask the personality to compare two costs
       constexpr bool operator()(const Cost& a, const Cost& b) const {
-
-        // Use personality's preferences to modify 'true' values
-        // This allows the AI to ignore or prioritise things
-        const float costA = 
-            a.remainingEnemyPenalty * remainingEnemyMultiplier +
-            a.lostAlliesPenalty * lostAlliesMultiplier +
-            a.alliesAtRiskPenalty * alliesAtRiskMultiplier +
-            a.unusedMPPenalty * unusedMPMultiplier +
-            a.unusedAPPenalty * unusedAPMultiplier;
-        const float costB = 
-            b.remainingEnemyPenalty * remainingEnemyMultiplier +
-            b.lostAlliesPenalty * lostAlliesMultiplier +
-            b.alliesAtRiskPenalty * alliesAtRiskMultiplier +
-            b.unusedMPPenalty * unusedMPMultiplier +
-            b.unusedAPPenalty * unusedAPMultiplier;
-
-        // Compare ultimate values
-        return costA < costB;
+        return score(a) < score(b);
       }
     };
 
     private:
 
-      // Store an A* functor
-      Controller::AStar<GameState, Action, Cost> astar;
+      // Store an A* functor for each variant of A*
+      Controller::Pathfinder<GameState, Action, Cost, PackedCodec> pathfinder;
+
+      // Remember the cost of actions between decisions
+      Controller::TranspositionTable<Cost> weightTable;
 
       // AI's personality
       Personality personality;
@@ -0,0 +1,214 @@
+// Strategy/Bitboard.h
+// A set of map tiles stored one bit per tile
+
+#ifndef STRATEGY_BITBOARD_H
+#define STRATEGY_BITBOARD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <bitset>
+#include <vector>
+#include <algorithm>
+
+// Seperate Strategy related classes from other games
+namespace Strategy {
+
+  // One bit per tile, indexed the same way as the map
+  // - Maps up to 16x16 fit in four words stored inline, so copying a board
+  //   never allocates
+  // - Larger maps spill into a vector of words
+  // - Boards grow as bits are set, and missing words are treated as zero, so
+  //   boards of different sizes can be combined
+  // - Operations are plain loops over words so compilers can vectorise them
+  class Bitboard {
+
+    public:
+
+      // Returned by next when there are no more set bits
+      static const std::size_t npos = static_cast<std::size_t>(-1);
+
+      // Check whether a tile is in the set
+      bool test(std::size_t i) const {
+        const std::size_t word = i >> 6;
+        return word < words() && (data()[word] >> (i & 63)) & 1;
+      }
+
+      // Add a tile to the set
+      void set(std::size_t i) {
+        const std::size_t word = i >> 6;
+        if (word >= words()) { grow(word + 1); }
+        data()[word] |= std::uint64_t(1) << (i & 63);
+      }
+
+      // Remove a tile from the set
+      void reset(std::size_t i) {
+        const std::size_t word = i >> 6;
+        if (word < words()) {
+          data()[word] &= ~(std::uint64_t(1) << (i & 63));
+        }
+      }
+
+      // Remove every tile
+      void clear() {
+        small_.fill(0);
+        large_.clear();
+      }
+
+      // Number of tiles in the set
+      std::size_t count() const {
+        std::size_t result = 0;
+        const std::uint64_t* w = data();
+        for (std::size_t i = 0, n = words(); i < n; ++i) {
+          result += popcount(w[i]);
+        }
+        return result;
+      }
+
+      // Check whether any tile is in the set
+      bool any() const {
+        std::uint64_t result = 0;
+        const std::uint64_t* w = data();
+        for (std::size_t i = 0, n = words(); i < n; ++i) { result |= w[i]; }
+        return result != 0;
+      }
+
+      // Check whether two sets share any tile
+      bool intersects(const Bitboard& o) const {
+        std::uint64_t result = 0;
+        const std::uint64_t* a = data();
+        const std::uint64_t* b = o.data();
+        for (std::size_t i = 0, n = std::min(words(), o.words()); i < n; ++i) {
+          result |= a[i] & b[i];
+        }
+        return result != 0;
+      }
+
+      // Find the first tile in the set at or after i
+      std::size_t next(std::size_t i) const {
+        std::size_t word = i >> 6;
+        const std::size_t n = words();
+        if (word >= n) { return npos; }
+        const std::uint64_t* w = data();
+        std::uint64_t bits = w[word] & (~std::uint64_t(0) << (i & 63));
+        while (bits == 0) {
+          if (++word >= n) { return npos; }
+          bits = w[word];
+        }
+        return (word << 6) + trailingZeros(bits);
+      }
+
+      // Call a function with every tile in the set, in ascending order
+      template <class F>
+      void forEach(const F& f) const {
+        const std::uint64_t* w = data();
+        for (std::size_t i = 0, n = words(); i < n; ++i) {
+          for (std::uint64_t bits = w[i]; bits != 0; bits &= bits - 1) {
+            f((i << 6) + trailingZeros(bits));
+          }
+        }
+      }
+
+      // Keep tiles that are also in another set
+      Bitboard& operator&=(const Bitboard& o) {
+        std::uint64_t* a = data();
+        const std::uint64_t* b = o.data();
+        const std::size_t n = words(), m = std::min(n, o.words());
+        for (std::size_t i = 0; i < m; ++i) { a[i] &= b[i]; }
+        for (std::size_t i = m; i < n; ++i) { a[i] = 0; }
+        return *this;
+      }
+
+      // Add tiles from another set
+      Bitboard& operator|=(const Bitboard& o) {
+        if (o.words() > words()) { grow(o.words()); }
+        std::uint64_t* a = data();
+        const std::uint64_t* b = o.data();
+        for (std::size_t i = 0, n = o.words(); i < n; ++i) { a[i] |= b[i]; }
+        return *this;
+      }
+
+      // Remove tiles that are in another set
+      Bitboard& remove(const Bitboard& o) {
+        std::uint64_t* a = data();
+        const std::uint64_t* b = o.data();
+        for (std::size_t i = 0, n = std::min(words(), o.words()); i < n; ++i) {
+          a[i] &= ~b[i];
+        }
+        return *this;
+      }
+
+      // Combine sets
+      friend Bitboard operator&(Bitboard a, const Bitboard& b) {
+        return a &= b;
+      }
+      friend Bitboard operator|(Bitboard a, const Bitboard& b) {
+        return a |= b;
+      }
+
+      // Compare the tiles in two sets
+      bool operator==(const Bitboard& o) const {
+        const std::uint64_t* a = data();
+        const std::uint64_t* b = o.data();
+        const std::size_t n = words(), m = o.words();
+        std::uint64_t diff = 0;
+        for (std::size_t i = 0; i < std::min(n, m); ++i) { diff |= a[i] ^ b[i]; }
+        for (std::size_t i = m; i < n; ++i) { diff |= a[i]; }
+        for (std::size_t i = n; i < m; ++i) { diff |= b[i]; }
+        return diff == 0;
+      }
+      bool operator!=(const Bitboard& o) const { return !(*this == o); }
+
+    private:
+
+      // Words stored inline, enough for a 16x16 map
+      static const std::size_t inlineWords = 4;
+
+      // Inline words, used until the board outgrows them
+      std::array<std::uint64_t, inlineWords> small_ = {};
+
+      // Words for larger boards, empty until needed
+      std::vector<std::uint64_t> large_;
+
+      // Access the words in use
+      std::size_t words() const {
+        return large_.empty() ? inlineWords : large_.size();
+      }
+      std::uint64_t* data() {
+        return large_.empty() ? small_.data() : large_.data();
+      }
+      const std::uint64_t* data() const {
+        return large_.empty() ? small_.data() : large_.data();
+      }
+
+      // Make room for at least n words
+      void grow(std::size_t n) {
+        if (n <= words()) { return; }
+        if (large_.empty()) {
+          large_.assign(small_.begin(), small_.end());
+          small_.fill(0);
+        }
+        large_.resize(n, 0);
+      }
+
+      // Count the set bits in a word
+      static std::size_t popcount(std::uint64_t w) {
+#if defined(__GNUC__)
+        return __builtin_popcountll(w);
+#else
+        return std::bitset<64>(w).count();
+#endif
+      }
+
+      // Count the zeros below the lowest set bit of a non-zero word
+      static std::size_t trailingZeros(std::uint64_t w) {
+#if defined(__GNUC__)
+        return __builtin_ctzll(w);
+#else
+        return popcount((w & (~w + 1)) - 1);
+#endif
+      }
+  };
+}
+
+#endif
@@ -5,6 +5,7 @@
 #define STRATEGY_COMMON_H
 
 #include <map>
+#include <cstdint>
 #include <SFML/Graphics.hpp>
 
 // Seperate strategy classes from other games
@@ -13,6 +14,10 @@ namespace Strategy {
   // A Strategy::Team is just an int
   typedef unsigned int Team;
 
+  // Highest team that can be stored on a map
+  // States keep a count for every team, so this is kept small
+  static const Team maxTeam = 15;
+
   // Coordinate in the game
   typedef sf::Vector2i Coord;
 
@@ -22,6 +27,32 @@ namespace Strategy {
   // Attack Range
   typedef int Range;
 
+  // Parts of a state that are given their own Zobrist keys
+  // Tiles use the low 48 bits for their index and contents, so other parts
+  // are tagged in the top byte to keep every input distinct
+  enum class ZobristPart : std::uint64_t {
+    Tile,
+    Size,
+    Turn,
+    Team,
+    Selection,
+    MP,
+    AP
+  };
+
+  // Get the Zobrist key for a part of a state with a given value
+  // Keys are generated with splitmix64 rather than stored in tables, so maps
+  // of any size are covered, and as it's a bijection distinct inputs never
+  // share a key
+  inline std::uint64_t zobristKey(ZobristPart part, std::uint64_t value) {
+    std::uint64_t n = (static_cast<std::uint64_t>(part) << 56) 
+        ^ (value & 0x00ffffffffffffffull);
+    n += 0x9e3779b97f4a7c15ull;
+    n = (n ^ (n >> 30)) * 0xbf58476d1ce4e5b9ull;
+    n = (n ^ (n >> 27)) * 0x94d049bb133111ebull;
+    return n ^ (n >> 31);
+  }
+
   // Different methods of drawing an object
   enum class RenderStyle {
     NotPlaying,
@@ -6,11 +6,13 @@
 
 #include <string>
 #include <map>
+#include <cstdint>
 
 #include "../../Console.h"
 #include "Objects.h"
 #include "Common.h"
 #include "Map.h"
+#include "Teams.h"
 
 // Seperate Strategy related classes from other games
 namespace Strategy {
@@ -25,9 +27,13 @@ namespace Strategy {
     Map map;
 
     // Member count of participating teams
-    std::map<Team, unsigned int> teams;
+    Teams teams;
     Team currentTeam;
 
+    // Whether the game is over, and who won, kept up to date by the rules
+    std::pair<GameStatus, Team> status = 
+        std::make_pair(GameStatus::InProgress, Team(0));
+
     // Track the currently selected piece
     Coord selection = Coord(-1, -1);
 
@@ -38,46 +44,84 @@ namespace Strategy {
     Points remainingAP = 0;
   };
 
+  // Everything needed to take back an action applied to a state in place
+  // Changed tiles are stored with whatever was on them before the action
+  struct UndoRecord {
+
+    // Whether the action was taken, if not the state wasn't changed
+    bool isApplied = false;
+
+    // Tiles the action changed, in the order they were changed
+    unsigned int tileCount = 0;
+    unsigned int tiles[2] = {};
+    std::pair<Team, Object> previous[2];
+
+    // Team that lost a unit, if any did
+    bool isUnitRemoved = false;
+    Team removedTeam = Team(0);
+
+    // The rest of the state as it was
+    std::pair<GameStatus, Team> status;
+    unsigned int turnNumber = 0;
+    Team currentTeam = Team(0);
+    Coord selection = Coord(-1, -1);
+    Points remainingMP = 0;
+    Points remainingAP = 0;
+  };
+
+  // Work out whether the game in a state is over from its team counts
+  // Games that go on too long are won by the team with the most units
+  inline void updateStatus(GameState& state) {
+    const unsigned int maxTurns = state.map.size.x * state.map.size.y * 2;
+    state.status = state.teams.getStatus(state.turnNumber > maxTurns);
+  }
+
   // Allow comparison of GameStates
-  // This just checks whether the boardstates are the same
+  // This checks everything that affects what can happen next: the board,
+  // whose turn it is, the selection and the points left to spend
+  // Team counts and the status are left out as they're derived from the
+  // board and the turn
   inline bool operator== (const GameState& a, const GameState& b) {
-    return a.currentTeam == b.currentTeam
+    return a.turnNumber == b.turnNumber
+      && a.currentTeam == b.currentTeam
       && a.selection == b.selection
-      && a.teams == b.teams
+      && a.remainingMP == b.remainingMP
+      && a.remainingAP == b.remainingAP
       && a.map.size == b.map.size
       && a.map.field == b.map.field;
   }
   inline bool operator!= (const GameState& a, const GameState& b) {
     return !(a == b);
   }
+
+  // Strong 64 bit Zobrist hash of everything compared by operator==
+  // The board's keys are kept up to date by the map as tiles change, so only
+  // a handful of keys for the rest of the state are added here
+  // Unlike std::hash this can be used on its own to remember things about a
+  // state without keeping a copy of it
+  inline std::uint64_t hashState(const GameState& st) {
+    const auto pack = [](int a, int b) {
+      return ((std::uint64_t)(a & 0xffffff) << 24) 
+          | (std::uint64_t)(b & 0xffffff);
+    };
+    return st.map.field.getHash()
+      ^ zobristKey(ZobristPart::Size, pack(st.map.size.x, st.map.size.y))
+      ^ zobristKey(ZobristPart::Turn, st.turnNumber)
+      ^ zobristKey(ZobristPart::Team, st.currentTeam)
+      ^ zobristKey(ZobristPart::Selection, 
+          pack(st.selection.x, st.selection.y))
+      ^ zobristKey(ZobristPart::MP, (std::uint32_t)st.remainingMP)
+      ^ zobristKey(ZobristPart::AP, (std::uint32_t)st.remainingAP);
+  }
 }
 
 // Hash function
-// It's not a perfect hash, but it will seperate distinct states based on vars
-// The inspiration for the hash was found on the following link, 7/11/2019:
-// https://codereview.stackexchange.com/questions/171999/specializing-stdhash-for-stdarray
-// For our project this is all we need
+// Uses the Zobrist hash, so it covers exactly what operator== compares and
+// states that differ only in where units stand no longer collide
 namespace std {
   template <> struct hash<Strategy::GameState> {
     size_t operator() (const Strategy::GameState& st) const {
-      std::hash<int> hasher;
-      std::size_t result = 0;
-      unsigned int unitsLeft = 0;
-      for (const auto& team : st.teams) {
-        unitsLeft += team.second;
-      }
-      const std::vector<int> toHash = {
-          (int) st.turnNumber, 
-          (int) st.currentTeam, 
-          (int) unitsLeft,
-          st.selection.x, 
-          st.selection.y,
-          st.remainingMP, 
-          st.remainingAP };
-      for (const auto& n : toHash) {
-        result = (result << 1) ^ hasher(n);
-      }
-      return result;
+      return static_cast<size_t>(Strategy::hashState(st));
     }
   };
 }
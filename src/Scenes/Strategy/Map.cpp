@@ -3,6 +3,109 @@
 
 #include "Map.h"
 
+#include <cassert>
+#include <climits>
+#include <algorithm>
+
+// Place an object on a tile
+void
+Strategy::Field::set(unsigned int index, Team team, Object object) {
+
+  assert(index < getTileCount() && team <= maxTeam);
+
+  // Remove whatever was there, which is all that placing nothing does
+  if (object == Object::Nothing) { 
+    erase(index);
+    return; 
+  }
+
+  // Pack the team and object together
+  // Leave the board alone if the tile already holds them
+  const auto cell = static_cast<std::uint16_t>(
+      (team << 8) | static_cast<unsigned int>(object));
+  const auto& cells = read().cells;
+  if (index < cells.size() && cells[index] == cell) { return; }
+  erase(index);
+
+  // Fill the tile
+  Board& board = write();
+  board.cells[index] = cell;
+  board.hash ^= getKey(index, cell);
+
+  // Add the tile to each layer it belongs to
+  board.occupied.set(index);
+  board.objects[static_cast<int>(object)].set(index);
+  if (isUnit(object)) {
+    if (team >= board.teams.size()) { board.teams.resize(team + 1); }
+    board.units.set(index);
+    board.teams[team].set(index);
+  }
+}
+
+// Clear a tile
+void
+Strategy::Field::erase(unsigned int index) {
+  if (!isOccupied(index)) { return; }
+  const auto old = get(index);
+  Board& board = write();
+  board.hash ^= getKey(index, board.cells[index]);
+  board.cells[index] = 0;
+  board.occupied.reset(index);
+  board.objects[static_cast<int>(old.second)].reset(index);
+  if (isUnit(old.second)) {
+    board.units.reset(index);
+    board.teams[old.first].reset(index);
+  }
+}
+
+// Remove every object, keeping the grid's size
+// Other fields sharing the board keep it
+void
+Strategy::Field::clear() {
+  *this = Field(getTileCount());
+}
+
+// Change the number of tiles, removing any objects past the end
+void
+Strategy::Field::resize(unsigned int tiles) {
+  if (tiles == getTileCount()) { return; }
+  std::vector<unsigned int> removed;
+  getOccupied().forEach([&](std::size_t index) {
+    if (index >= tiles) { removed.push_back(index); }
+  });
+  for (const auto index : removed) { erase(index); }
+  write().cells.resize(tiles, 0);
+}
+
+// Compare the objects on two fields
+// Empty tiles are always zero, so only occupied tiles are checked
+bool
+Strategy::Field::operator==(const Field& o) const {
+  if (board_ == o.board_) { return true; }
+  const Board& a = read();
+  const Board& b = o.read();
+  if (a.hash != b.hash || a.occupied != b.occupied) { return false; }
+  bool isEqual = true;
+  a.occupied.forEach([&](std::size_t index) {
+    isEqual = isEqual && a.cells[index] == b.cells[index];
+  });
+  return isEqual;
+}
+
+// Access the board for writing
+// A board is only ever changed by the one field holding it, so copies can
+// be shared freely between threads
+Strategy::Field::Board&
+Strategy::Field::write() {
+  if (!board_) { 
+    board_ = std::make_shared<Board>(); 
+  }
+  else if (board_.use_count() > 1) { 
+    board_ = std::make_shared<Board>(*board_); 
+  }
+  return *board_;
+}
+
 // Allow outputting of map
 std::ostream& 
 Strategy::operator<<(std::ostream& os, const Map& m) {
@@ -41,18 +144,24 @@ Strategy::operator>> (std::istream& is, Map& m) {
 
   // 1. Size
   is >> m.size.x >> c >> m.size.y;
+  if (!is || m.size.x <= 0 || m.size.y <= 0
+      || m.size.x > INT_MAX / m.size.y) {
+    is.setstate(std::ios_base::failbit);
+    return is;
+  }
 
   // 2. MP and AP
   is >> m.startingMP >> c >> m.startingAP;
 
   // 3. Prepare receive map objects
   is >> c ;
-  m.field.clear();
+  const unsigned int tiles = m.size.x * m.size.y;
+  m.field = Field(tiles);
 
   // 4. Receive map objects while not '}'
   is >> c;
   unsigned int counter = 0;
-  while (counter < m.size.x * m.size.y && c != '}') {
+  while (counter < tiles && c != '}') {
 
     // Ensure this loop only iterates w*h times
     counter += 1;
@@ -67,15 +176,29 @@ Strategy::operator>> (std::istream& is, Map& m) {
         >> team >> c
         >> object >> c;
 
+    // Refuse objects off the map, of unknown types or in unknown teams
+    // Older maps could use teams up to 255, so say why those are refused
+    if (is && team > maxTeam) {
+      Console::log("[Error] Map uses team %u, but teams only go up to %u.",
+          team, maxTeam);
+    }
+    if (!is || index >= tiles || object < 0 || object >= objectCount
+        || team > maxTeam) {
+      is.setstate(std::ios_base::failbit);
+      return is;
+    }
+
     // Insert data to field
-    m.field[index] = std::make_pair(team, static_cast<Object>(object));
+    m.field.set(index, team, static_cast<Object>(object));
 
     // Check to see if the next line contains '(' or '{'
     is >> c;
   }
 
-  // 5. Consume final endline character
-  is >> c;
+  // 5. Check for the terminator and consume the final endline character
+  // Skipping whitespace alone doesn't fail at the end of the stream
+  if (c != '}') { is.setstate(std::ios_base::failbit); }
+  is >> std::ws;
 
   // Return instream
   return is;
@@ -4,7 +4,11 @@
 #ifndef STRATEGY_MAP_H
 #define STRATEGY_MAP_H
 
-#include <map>
+#include <cstdint>
+#include <array>
+#include <memory>
+#include <vector>
+#include <utility>
 #include <istream>
 #include <ostream>
 #include <string>
@@ -12,10 +16,183 @@
 #include "../../Console.h"
 #include "Objects.h"
 #include "Common.h"
+#include "Bitboard.h"
 
 // Seperate Strategy related classes from other games
 namespace Strategy {
 
+  // Objects on the map, stored in a flat grid indexed by tile
+  // - The grid has a fixed number of tiles, which every index must be below
+  // - Each tile is packed into 16 bits, the team above the object
+  // - Bitboards track which tiles hold anything, walls, units, each team's
+  //   units and each type of unit, so most questions about the board are a
+  //   few word operations
+  // - A Zobrist hash of every tile is updated as tiles change
+  // - Iterating yields objects in the same order as a std::map of index to
+  //   (team, object)
+  // - Copies share one reference counted board, which is only duplicated
+  //   when a copy that shares it is changed, so states that don't change the
+  //   board never copy it and shared boards compare by pointer
+  class Field {
+
+    public:
+
+      // Make an empty field with a number of tiles
+      explicit Field(unsigned int tiles = 0) {
+        if (tiles > 0) {
+          board_ = std::make_shared<Board>();
+          board_->cells.resize(tiles, 0);
+        }
+      }
+
+      // An occupied tile, as it would appear in a std::map
+      typedef std::pair<unsigned int, std::pair<Team, Object>> value_type;
+
+      // Iterates occupied tiles in index order
+      class Iterator {
+        public:
+          Iterator(const Field& field, std::size_t index)
+            : field_(&field), index_(index) {}
+          value_type operator*() const {
+            return value_type(index_, field_->get(index_));
+          }
+          Iterator& operator++() { 
+            index_ = field_->getOccupied().next(index_ + 1); 
+            return *this; 
+          }
+          bool operator==(const Iterator& o) const { 
+            return index_ == o.index_; 
+          }
+          bool operator!=(const Iterator& o) const { 
+            return index_ != o.index_; 
+          }
+        private:
+          const Field* field_;
+          std::size_t index_;
+      };
+
+      // Iterate through occupied tiles
+      Iterator begin() const { 
+        return Iterator(*this, getOccupied().next(0)); 
+      }
+      Iterator end() const { return Iterator(*this, Bitboard::npos); }
+
+      // Number of occupied tiles
+      std::size_t size() const { return getOccupied().count(); }
+      bool empty() const { return !getOccupied().any(); }
+
+      // Number of tiles in the grid
+      unsigned int getTileCount() const { 
+        return static_cast<unsigned int>(read().cells.size()); 
+      }
+
+      // Get the team and object on a tile
+      std::pair<Team, Object> get(unsigned int index) const {
+        const auto& cells = read().cells;
+        if (index >= cells.size()) { 
+          return std::make_pair(Team(0), Object::Nothing); 
+        }
+        const std::uint16_t cell = cells[index];
+        return std::make_pair(Team(cell >> 8), Object(cell & 0xff));
+      }
+
+      // Check whether anything is on a tile
+      bool isOccupied(unsigned int index) const { 
+        return getOccupied().test(index); 
+      }
+
+      // Tiles with anything on them
+      const Bitboard& getOccupied() const { return read().occupied; }
+
+      // Tiles with walls on them
+      const Bitboard& getWalls() const { return getObjects(Object::Wall); }
+
+      // Tiles with units of any team on them
+      const Bitboard& getUnits() const { return read().units; }
+
+      // Tiles with a given type of object on them
+      const Bitboard& getObjects(Object object) const {
+        return read().objects[static_cast<int>(object)];
+      }
+
+      // Tiles with a team's units on them
+      const Bitboard& getTeamUnits(Team team) const {
+        static const Bitboard none;
+        const auto& teams = read().teams;
+        return team < teams.size() ? teams[team] : none;
+      }
+
+      // Number of teams that may have units, for iterating getTeamUnits
+      Team getTeamLimit() const { return Team(read().teams.size()); }
+
+      // Zobrist hash of every occupied tile
+      std::uint64_t getHash() const { return read().hash; }
+
+      // Check whether two fields share the same board
+      bool isSharedWith(const Field& o) const { return board_ == o.board_; }
+
+      // Place an object on a tile, replacing whatever was there
+      // Placing nothing clears the tile, and the tile must be in the grid
+      // and the team no higher than maxTeam
+      void set(unsigned int index, Team team, Object object);
+
+      // Clear a tile
+      void erase(unsigned int index);
+
+      // Remove every object
+      void clear();
+
+      // Change the number of tiles, removing any objects past the end
+      void resize(unsigned int tiles);
+
+      // Compare the objects on two fields
+      bool operator==(const Field& o) const;
+      bool operator!=(const Field& o) const { return !(*this == o); }
+
+    private:
+
+      // Everything stored about the objects on the map
+      struct Board {
+
+        // Packed team and object for each tile, one per tile in the grid
+        std::vector<std::uint16_t> cells;
+
+        // Tiles with anything on them
+        Bitboard occupied;
+
+        // Tiles with units on them
+        Bitboard units;
+
+        // Tiles holding each type of object, indexed by Object
+        std::array<Bitboard, objectCount> objects;
+
+        // Tiles holding each team's units, indexed by Team
+        std::vector<Bitboard> teams;
+
+        // Keys of every occupied tile xor'd together
+        std::uint64_t hash = 0;
+      };
+
+      // The board, shared between copies and never changed while shared
+      // A field without any tiles has no board at all
+      std::shared_ptr<Board> board_;
+
+      // Access the board for reading
+      const Board& read() const {
+        static const Board empty;
+        return board_ ? *board_ : empty;
+      }
+
+      // Access the board for writing, taking a copy of it if it's shared
+      Board& write();
+
+      // Get the key for a tile holding a packed cell
+      static std::uint64_t getKey(unsigned int index, std::uint16_t cell) {
+        return zobristKey(ZobristPart::Tile, 
+            (static_cast<std::uint64_t>(index) << 16) | cell);
+      }
+  };
+
   // Store all data related to the game's map
   struct Map {
 
@@ -23,19 +200,27 @@ namespace Strategy {
     Coord size = Coord(5, 5);
 
     // Map of notable pieces of obstacles
-    std::map<unsigned int, std::pair<Team, Object>> field;
+    Field field = Field(size.x * size.y);
 
     // Starting movement point amount for this map
     Points startingMP = 5;
 
     // Starting action point amount for this map
     Points startingAP = 3;
+
+    // Change the size of the battlefield, removing objects that fall off it
+    void resize(const Coord& s) {
+      size = s;
+      field.resize(s.x * s.y);
+    }
   };
 
   // Save the map to a stream
   std::ostream& operator<< (std::ostream& os, const Map& m);
 
   // Load a map from a stream
+  // The stream fails if an object lies off the map, isn't known or belongs
+  // to a team above maxTeam
   std::istream& operator>> (std::istream& is, Map& m);
 }
 #endif
@@ -21,6 +21,7 @@ namespace Strategy {
     SniperUnit,
     LaserUnit
   };
+  static const int objectCount = 6;
 
   // Check for unit
   inline bool isUnit(const Object& o) {
@@ -0,0 +1,232 @@
+// Strategy/PackedState.h
+// Compact encodings of game states and actions for searches to store
+
+#ifndef STRATEGY_PACKEDSTATE_H
+#define STRATEGY_PACKEDSTATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <functional>
+
+#include "Objects.h"
+#include "Common.h"
+#include "Action.h"
+#include "GameState.h"
+
+// Seperate Strategy related classes from other games
+namespace Strategy {
+
+  // An action packed into 32 bits
+  // The tag sits in the top 4 bits, then x + 1 and y + 1 in 14 bits each
+  typedef std::uint32_t PackedAction;
+
+  // Pack an action, which must have coordinates between -1 and 16382
+  inline PackedAction packAction(const Action& action) {
+    return (static_cast<std::uint32_t>(action.tag) << 28)
+        | ((static_cast<std::uint32_t>(action.location.x + 1) & 0x3fff) << 14)
+        | (static_cast<std::uint32_t>(action.location.y + 1) & 0x3fff);
+  }
+
+  // Unpack an action packed by packAction
+  inline Action unpackAction(PackedAction packed) {
+    return Action(static_cast<Action::Tag>(packed >> 28), Coord(
+        static_cast<int>((packed >> 14) & 0x3fff) - 1,
+        static_cast<int>(packed & 0x3fff) - 1));
+  }
+
+  // Everything a search needs to tell states apart, in one cache line
+  // - Units are listed by tile in ascending order, with their team and type
+  // - Walls can only be destroyed during a search, so they are stored as a
+  //   mask over the walls of the state the search started from
+  // - Everything else about the map is the same for the whole search
+  // Unused entries are zero so keys can be compared and hashed as bytes
+  struct PackedState {
+
+    // Most units and walls a key can hold
+    static const std::size_t maxUnits = 16;
+    static const std::size_t maxWalls = 64;
+
+    // Bit i is set when the starting state's i'th wall has been destroyed
+    std::uint64_t removedWalls = 0;
+
+    // Tile of each unit, in ascending order
+    std::uint16_t cells[maxUnits] = {};
+
+    // Team of each unit above its type, counted from the melee unit
+    std::uint8_t kinds[maxUnits] = {};
+
+    // Turn number, and the selected tile plus one, or zero for none
+    std::uint16_t turnNumber = 0;
+    std::uint16_t selection = 0;
+
+    // Team playing, number of units, and points left to spend
+    std::uint8_t currentTeam = 0;
+    std::uint8_t units = 0;
+    std::int8_t remainingMP = 0;
+    std::int8_t remainingAP = 0;
+  };
+  static_assert(sizeof(PackedState) == 64, "PackedState should be 64 bytes");
+
+  // Compare packed states byte for byte
+  inline bool operator== (const PackedState& a, const PackedState& b) {
+    return std::memcmp(&a, &b, sizeof(PackedState)) == 0;
+  }
+  inline bool operator!= (const PackedState& a, const PackedState& b) {
+    return !(a == b);
+  }
+
+  // Stores game states as PackedStates and actions as PackedActions
+  // Decoded states share the starting state's board until they differ
+  class PackedCodec {
+
+    public:
+
+      // Types stored in place of states and actions
+      typedef PackedState StateKey;
+      typedef PackedAction ActionKey;
+
+      // Check whether everything reachable from a state fits in a key
+      // Units are only ever removed and points only reset to the map's
+      // starting values, so checking the start is enough
+      bool canEncode(const GameState& state) const {
+        const auto& map = state.map;
+        const auto tiles = (long)map.size.x * map.size.y;
+        const auto inRange = [](Points p) { return p >= 0 && p <= 127; };
+        if (map.size.x <= 0 || map.size.y <= 0 || tiles > 16384
+            || map.size.x > 16382 || map.size.y > 16382
+            || state.map.field.getUnits().count() > PackedState::maxUnits
+            || state.map.field.getWalls().count() > PackedState::maxWalls
+            || state.map.field.getTeamLimit() > 64
+            || state.currentTeam > 255
+            || state.turnNumber > 0xffff - 1
+            || !inRange(state.remainingMP) || !inRange(state.remainingAP)
+            || !inRange(map.startingMP) || !inRange(map.startingAP)) {
+          return false;
+        }
+        return state.selection == Coord(-1, -1) || isOnMap(state.selection);
+      }
+
+      // Remember the walls and map of the state a search starts from
+      void prepare(const GameState& start) {
+        map_ = start.map;
+        map_.field.clear();
+        walls_.clear();
+        start.map.field.getWalls().forEach([&](std::size_t index) {
+          const auto wall = start.map.field.get(index);
+          map_.field.set(index, wall.first, wall.second);
+          walls_.push_back(static_cast<std::uint16_t>(index));
+        });
+      }
+
+      // Pack a state reachable from the prepared one
+      PackedState encodeState(const GameState& state) const {
+        PackedState key;
+        const auto& field = state.map.field;
+
+        // Mark the walls that have gone
+        if (field.getWalls() != map_.field.getWalls()) {
+          for (std::size_t i = 0; i < walls_.size(); ++i) {
+            if (field.get(walls_[i]).second != Object::Wall) {
+              key.removedWalls |= std::uint64_t(1) << i;
+            }
+          }
+        }
+
+        // List every unit in tile order
+        field.getUnits().forEach([&](std::size_t index) {
+          const auto unit = field.get(index);
+          key.cells[key.units] = static_cast<std::uint16_t>(index);
+          key.kinds[key.units] = static_cast<std::uint8_t>((unit.first << 2)
+              | (static_cast<int>(unit.second)
+                  - static_cast<int>(Object::MeleeUnit)));
+          key.units += 1;
+        });
+
+        // Store everything else as it is
+        key.turnNumber = static_cast<std::uint16_t>(state.turnNumber);
+        key.selection = isOnMap(state.selection) ? static_cast<std::uint16_t>(
+            state.selection.x + state.selection.y * map_.size.x + 1) : 0;
+        key.currentTeam = static_cast<std::uint8_t>(state.currentTeam);
+        key.remainingMP = static_cast<std::int8_t>(state.remainingMP);
+        key.remainingAP = static_cast<std::int8_t>(state.remainingAP);
+        return key;
+      }
+
+      // Rebuild a full state from a key
+      GameState decodeState(const PackedState& key) const {
+        GameState state;
+        state.map = map_;
+        auto& field = state.map.field;
+
+        // Take away destroyed walls
+        for (std::uint64_t bits = key.removedWalls; bits != 0;
+            bits &= bits - 1) {
+          std::size_t i = 0;
+          while (((bits >> i) & 1) == 0) { ++i; }
+          field.erase(walls_[i]);
+        }
+
+        // Put back every unit and count them by team
+        for (std::size_t i = 0; i < key.units; ++i) {
+          const Team team = key.kinds[i] >> 2;
+          const auto object = static_cast<Object>(
+              static_cast<int>(Object::MeleeUnit) + (key.kinds[i] & 3));
+          field.set(key.cells[i], team, object);
+          state.teams.addUnit(team);
+        }
+
+        // Restore everything else
+        state.turnNumber = key.turnNumber;
+        state.currentTeam = key.currentTeam;
+        state.selection = key.selection == 0 ? Coord(-1, -1) : Coord(
+            (key.selection - 1) % map_.size.x,
+            (key.selection - 1) / map_.size.x);
+        state.remainingMP = key.remainingMP;
+        state.remainingAP = key.remainingAP;
+        updateStatus(state);
+        return state;
+      }
+
+      // Convert actions
+      PackedAction encodeAction(const Action& action) const {
+        return packAction(action);
+      }
+      Action decodeAction(PackedAction key) const {
+        return unpackAction(key);
+      }
+
+    private:
+
+      // The starting map with only its walls on it
+      Map map_;
+
+      // Tile of each of the starting map's walls, in ascending order
+      std::vector<std::uint16_t> walls_;
+
+      // Check that a coordinate is on the prepared map
+      bool isOnMap(const Coord& c) const {
+        return c.x >= 0 && c.x < map_.size.x && c.y >= 0 && c.y < map_.size.y;
+      }
+  };
+}
+
+// Hash function
+// Mixes the key one word at a time, as keys are plain bytes
+namespace std {
+  template <> struct hash<Strategy::PackedState> {
+    size_t operator() (const Strategy::PackedState& key) const {
+      std::uint64_t words[sizeof(key) / sizeof(std::uint64_t)];
+      std::memcpy(words, &key, sizeof(key));
+      std::uint64_t result = 0;
+      for (const auto word : words) {
+        result = (result ^ word) * 0x9e3779b97f4a7c15ull;
+        result ^= result >> 29;
+      }
+      return static_cast<size_t>(result);
+    }
+  };
+}
+
+#endif
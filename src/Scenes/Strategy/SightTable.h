@@ -0,0 +1,84 @@
+// Strategy/SightTable.h
+// The tiles every line of sight passes through on a map of a given size
+
+#ifndef STRATEGY_SIGHTTABLE_H
+#define STRATEGY_SIGHTTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+#include "Common.h"
+#include "Bitboard.h"
+
+// Seperate Strategy related classes from other games
+namespace Strategy {
+
+  // Tiles strictly between the ends of every line of sight on a map
+  // - Lines only depend on the difference between their ends, so one ray is
+  //   kept per difference rather than per pair of tiles
+  // - Rays are index offsets from the start of the line, which stay on the
+  //   map as long as both ends are on it
+  // - A line is clear when none of its ray's tiles are occupied, the ends
+  //   themselves never block it
+  class SightTable {
+
+    public:
+
+      // Build the table for a map size
+      // Trace is called once per difference with two tiles on the map, and
+      // returns every tile on the line between them, ends included
+      template <class Trace>
+      SightTable(const Coord& size, const Trace& trace) : size_(size) {
+        starts_.reserve((2 * size.x - 1) * (2 * size.y - 1) + 1);
+        for (int dy = 1 - size.y; dy < size.y; ++dy) {
+          for (int dx = 1 - size.x; dx < size.x; ++dx) {
+            starts_.push_back(static_cast<std::uint32_t>(offsets_.size()));
+            const Coord from(std::max(0, -dx), std::max(0, -dy));
+            const auto& line = trace(from, Coord(from.x + dx, from.y + dy));
+            for (std::size_t i = 1; i + 1 < line.size(); ++i) {
+              offsets_.push_back((line[i].x - from.x)
+                  + (line[i].y - from.y) * size.x);
+            }
+          }
+        }
+        starts_.push_back(static_cast<std::uint32_t>(offsets_.size()));
+      }
+
+      // Size of map the table is for
+      const Coord& getSize() const { return size_; }
+
+      // Check that nothing stands between two tiles on the map
+      bool isClear(
+          const Bitboard& occupied,
+          const Coord& from,
+          const Coord& to) const {
+        const std::size_t d = getDifference(from, to);
+        const int origin = from.x + from.y * size_.x;
+        for (std::uint32_t i = starts_[d]; i < starts_[d + 1]; ++i) {
+          if (occupied.test(origin + offsets_[i])) { return false; }
+        }
+        return true;
+      }
+
+    private:
+
+      // Size of map the table is for
+      Coord size_;
+
+      // Where each difference's ray starts in offsets, plus one past the end
+      std::vector<std::uint32_t> starts_;
+
+      // Index offsets of every ray's tiles, one ray after another
+      std::vector<int> offsets_;
+
+      // Position of the difference between two tiles in starts
+      std::size_t getDifference(const Coord& from, const Coord& to) const {
+        return (to.x - from.x + size_.x - 1)
+            + (to.y - from.y + size_.y - 1) * (2 * size_.x - 1);
+      }
+  };
+}
+
+#endif
@@ -6,6 +6,7 @@
 #include "AI/CaseTwo/CaseTwo.h"
 #include "AI/CaseThree/CaseThree.h"
 #include "AI/CaseFour/CaseFour.h"
+#include "AI/Beam.h"
 
 ///////////////////////////////////////////
 // SCENE FUNCTIONS:
@@ -84,6 +85,9 @@ Strategy::Game::onUpdate(const sf::Time& dt) {
   if (isAIThinking_) {
     continueGame();
   }
+
+  // Tidy up after decisions that were abandoned
+  collectCancelledAI();
 }
 
 // Handle input and game size changes
@@ -238,6 +242,7 @@ Strategy::Game::onEvent(const sf::Event& event) {
         auto newState = state;
         newState.map = map.second;
         newState.teams = countTeams(newState.map);
+        updateStatus(newState);
         pushState(newState);
 
         // View the changes
@@ -330,6 +335,34 @@ Strategy::Game::onRender(sf::RenderWindow& window) {
     }
   }
 
+  // Highlight tiles the selected unit can reach this turn in move mode
+  const auto& selected = readMap(state.map, state.selection);
+  if (!enableEditor_ && !isInAttackMode_
+      && getController(state.currentTeam) == Controller::Type::Human
+      && validateCoords(state.map, state.selection)
+      && isUnit(selected.second) 
+      && selected.first == state.currentTeam) {
+    recalculateMoveField(state);
+    const auto unitCost = getUnitMPCost(selected.second);
+    rect.setFillColor(getTeamColour(state.currentTeam) 
+        * sf::Color(255, 255, 255, 40));
+    for (unsigned int i = 0; i < moveDistance_.size(); ++i) {
+      if (moveDistance_[i] > 0 
+          && moveDistance_[i] * unitCost <= state.remainingMP) {
+        const auto c = indexToCoord(state.map, i);
+        rect.setPosition(sf::Vector2f(
+            left_ + c.x * tileLength_,
+            top_ + c.y * tileLength_));
+        window.draw(rect);
+      }
+    }
+  }
+
+  // Shade tiles the replayed search focused on
+  if (enableSearchReplay_ && !replay_.empty()) {
+    renderReplay(window, state);
+  }
+
   // Dim the colour for enemies that have you in sight
   // When combined with the above, it'll glow more if you can see them
   rect.setFillColor(sf::Color(255, 0, 0, 35));
@@ -438,11 +471,24 @@ Strategy::Game::onShow() {
   resizeGame();
 }
 
+// Don't leave the AI thinking in the background
+void
+Strategy::Game::onHide() {
+  stopAI();
+}
+
+// Make sure the AI isn't thinking when the app closes
+void
+Strategy::Game::onQuit() {
+  stopAI();
+}
+
 // Add a menu entry to the debug menu
 void 
 Strategy::Game::addDebugMenuEntries() {
   ImGui::MenuItem("Map Editor", NULL, &enableEditor_);
   ImGui::MenuItem("AI Viewer", NULL, &enableAIViewer_);
+  ImGui::MenuItem("Search Replay", NULL, &enableSearchReplay_);
 }
 
 // Add details to debug windows
@@ -491,6 +537,17 @@ Strategy::Game::addDebugDetails() {
         : "Action points: %d / %d"),
         state.remainingAP, state.map.startingAP, apCost_);
     ImGui::Text("Attacking: %s", isInAttackMode_ ? "true" : "false");
+    if (ImGui::Button("Check apply and undo")) {
+      const auto check = checkApplyAndUndo(state, 1000);
+      applyUndoCheck_ = check.first
+          ? "Matched takeAction for " + std::to_string(check.second) 
+              + " actions"
+          : "Mismatch at action " + std::to_string(check.second);
+    }
+    if (!applyUndoCheck_.empty()) {
+      ImGui::SameLine();
+      ImGui::Text("%s", applyUndoCheck_.c_str());
+    }
     ImGui::Spacing();
     ImGui::Separator();
     ImGui::Text("Participating Teams:"); ImGui::NextColumn();
@@ -504,10 +561,15 @@ Strategy::Game::addDebugDetails() {
       ImGui::NextColumn();
       auto& controller = getControllerRef(kvp.first);
       std::string comboLabel;
-      ImGui::Combo(
+      const bool changed = ImGui::Combo(
           (std::string("###teamCombo") + std::to_string(kvp.first)).c_str(),
           reinterpret_cast<int*>(&controller), 
           Controller::typeList, IM_ARRAYSIZE(Controller::typeList));
+
+      // The AI's decision is no longer wanted if its controller changed
+      if (changed) {
+        stopAI();
+      }
       ImGui::NextColumn();
       ImGui::Separator();
     }
@@ -521,18 +583,22 @@ Strategy::Game::addDebugDetails() {
       ImGui::SameLine();
       ImGui::TextColored(col, "(%u members left)", teamIt->second);
     }
+    if (ImGui::Button("Reset Game")) { 
+      resetGame(); 
+    }
+    ImGui::SameLine();
     if (!isAIThinking_) {
-      if (ImGui::Button("Reset Game")) { 
-        resetGame(); 
-      }
-      ImGui::SameLine();
       if (ImGui::Button("Continue Game")) { 
         clearFutureStates();
         continueGame(); 
       }
     }
     else {
-      ImGui::Text("AI is thinking. Restart program to terminate.");
+      if (ImGui::Button("Stop AI")) { 
+        stopAI(); 
+      }
+      ImGui::SameLine();
+      ImGui::Text("AI is thinking.");
     }
   }
   ImGui::End();
@@ -570,8 +636,14 @@ Strategy::Game::addDebugDetails() {
         if (mapstr != "") {
           std::stringstream ss;
           ss << mapstr;
-          ss >> currentMap_;
-          resetGame();
+          Map map;
+          if (ss >> map) {
+            currentMap_ = map;
+            resetGame();
+          }
+          else {
+            Console::log("[Error] Couldn't load map %s.", name);
+          }
         }
       }
       if (ImGui::TreeNode("Editor:")) {
@@ -579,6 +651,7 @@ Strategy::Game::addDebugDetails() {
             hoveredTile_.x, 
             hoveredTile_.y);
         ImGui::InputInt("Team", reinterpret_cast<int*>(&editorTeam_));
+        if (editorTeam_ > maxTeam) { editorTeam_ = maxTeam; }
         ImGui::Combo("Object",
             reinterpret_cast<int*>(&editorObject_), 
             objectList, IM_ARRAYSIZE(objectList));
@@ -608,13 +681,13 @@ Strategy::Game::addDebugDetails() {
         if (height < 4) { height = 4; }
         if (ImGui::Button("Generate Blank Map")) {
           Map map;
-          map.size = Coord(width, height);
+          map.resize(Coord(width, height));
           currentMap_ = map;
           resetGame();
         }
         if (ImGui::Button("Generate Default Map")) {
           Map map;
-          map.size = Coord(width, height);
+          map.resize(Coord(width, height));
           currentMap_ = getDefaultUnitPlacement(map);
           resetGame();
         }
@@ -657,6 +730,105 @@ Strategy::Game::addDebugDetails() {
                 ai->getStatesProcessed());
             ImGui::Text("Open states remaining: %u", 
                 ai->getOpenStatesRemaining());
+            ImGui::Text("Closed states: %u", 
+                ai->getClosedStates());
+            const auto probes = ai->getClosedSetProbes();
+            ImGui::Text("Closed set probes: %lu (%.2f per lookup)", 
+                probes.second, 
+                probes.first > 0 ? (float)probes.second / probes.first : 0.f);
+            const auto cache = ai->getCacheHits();
+            ImGui::Text("Cost cache hits: %lu of %lu (%.1f%%)", 
+                cache.second, cache.first,
+                cache.first > 0 ? 100.f * cache.second / cache.first : 0.f);
+            ImGui::Text("Last decision took: %.1f ms", aiDecisionTime_);
+            if (ai->wasBudgetExhausted()) {
+              ImGui::Text("Budget exhausted, used the best plan so far.");
+            }
+            if (ImGui::TreeNode("Search stats:")) {
+              const bool isMeasured = searchStatsAI_ == ai;
+              const auto stats = isMeasured 
+                  ? searchStats_ : Controller::SearchStats();
+              if (!isMeasured) {
+                ImGui::Text("No decision has finished yet.");
+              }
+              ImGui::Text("Expanded: %lu, generated: %lu (%.2f per state)",
+                  stats.expanded, stats.generated, 
+                  stats.getBranchingFactor());
+              ImGui::Text("Search took: %.1f ms", stats.milliseconds);
+              if (stats.isPartial) {
+                ImGui::Text("Duplicates, collisions and peaks: n/a");
+                ImGui::Text("Only A* measures these.");
+              }
+              else {
+                ImGui::Text("Duplicates: %lu, reprioritised: %lu", 
+                    stats.duplicates, stats.reprioritised);
+                ImGui::Text("Hash collisions: %lu in %lu lookups (%.2f%%)",
+                    stats.hashCollisions, stats.lookups,
+                    100.0 * stats.getCollisionRate());
+                ImGui::Text("Peak open: %zu, peak closed: %zu (~%.1f KB)",
+                    stats.peakOpen, stats.peakClosed,
+                    stats.approximateBytes / 1024.f);
+              }
+              bool isTiming = ai->isTimingSearch();
+              if (ImGui::Checkbox("Time callables (slows the search)",
+                  &isTiming)) {
+                ai->setTimingSearch(isTiming);
+              }
+              if (isTiming && !stats.isPartial) {
+                const std::pair<const char*, Controller::CallbackStats> 
+                    callbacks[] = {
+                  {"getPossibleActions", stats.getPossibleActions},
+                  {"takeAction", stats.takeAction},
+                  {"weighAction", stats.weighAction},
+                  {"heuristic", stats.heuristic},
+                  {"isStateEndpoint", stats.isStateEndpoint}};
+                for (const auto& callback : callbacks) {
+                  ImGui::Text("%s: %lu calls, %.2f ms (%.0f%%)", 
+                      callback.first, 
+                      callback.second.calls, 
+                      callback.second.milliseconds,
+                      stats.milliseconds > 0.0 ? 100.0 
+                          * callback.second.milliseconds / stats.milliseconds
+                          : 0.0);
+                }
+              }
+              if (!stats.isPartial) {
+                const std::vector<float> histogram(
+                    stats.branching.begin(), stats.branching.end());
+                ImGui::PlotHistogram("Branching", histogram.data(), 
+                    (int)histogram.size(), 0, NULL, 0.f, FLT_MAX, 
+                    ImVec2(0.f, 60.f));
+              }
+              ImGui::Checkbox("Log each decision to search_stats.jsonl",
+                  &isLoggingSearchStats_);
+              ImGui::TreePop();
+            }
+            ImGui::Spacing();
+
+            // Measure how parallel A* scales on this state in the
+            // background, which can be stopped like any decision
+            // Settings are read and changed by the AI's thread, so they're
+            // hidden until it's done
+            if (isTimingThreads_ && thinkingAI_ == ai) {
+              ImGui::Text("Timing parallel A* against threads...");
+            }
+            else if (isAIBusy(ai)) {
+              ImGui::Text("Settings can be changed once the AI stops.");
+            }
+            else {
+              ai->debugBudget();
+              if (!isAIThinking_
+                  && ImGui::Button("Time parallel A* against threads")) {
+                timeAIThreads(ai, state);
+              }
+            }
+            for (const auto& timing : threadTimings_) {
+              ImGui::Text("%u threads: %.1f ms, %u states (%.2fx)", 
+                  timing.threads, timing.milliseconds, timing.statesProcessed,
+                  threadTimings_.front().milliseconds / timing.milliseconds);
+            }
+            ImGui::Spacing();
+            ai->debugSuboptimality();
             ImGui::Spacing();
             ai->debug();
           }
@@ -677,6 +849,14 @@ Strategy::Game::addDebugDetails() {
       ImGui::End();
     }
   }
+
+  // Record and replay the states searched by decisions
+  if (enableSearchReplay_) {
+    if (ImGui::Begin("Search Replay", &enableSearchReplay_)) {
+      debugSearchReplay(state);
+    }
+    ImGui::End();
+  }
 }
 
 ///////////////////////////////////////////
@@ -689,6 +869,7 @@ Strategy::Game::addDebugDetails() {
 // Attempt to take action on a gamestate
 std::pair<bool, Strategy::GameState>
 Strategy::Game::takeAction(const GameState& state, const Action& action) {
+  Trace::Scope trace("Strategy::Game::takeAction", "rules", true);
 
   // If the game is over, don't accept any moves
   const auto& status = getGameStatus(state);
@@ -712,29 +893,18 @@ Strategy::Game::takeAction(const GameState& state, const Action& action) {
         && dest.second == Object::Nothing) {
 
       // Create a new state with the move performed
-      auto newState = state;
-      auto updateAttempt = updateMap(
-          newState.map,
-          action.location,
-          unit.second,
-          unit.first);
-
-      // If the unit is in the new place successfully
-      // remove the old unit after duplication
-      if (updateAttempt.first) {
-        updateAttempt = updateMap(
-            updateAttempt.second,
-            state.selection,
-            Object::Nothing,
-            state.currentTeam);
-
-        // If this was also successful, update newState and return
-        if (updateAttempt.first) {
-          newState.map = updateAttempt.second;
-          newState.selection = action.location;
-          newState.remainingMP -= getUnitMPCost(unit.second);
-          return std::make_pair(true, newState);
-        }
+      // The board is shared with the old state until the first tile changes,
+      // so it's only copied once
+      if (validateCoords(state.map, action.location)
+          && validateCoords(state.map, state.selection)) {
+        auto newState = state;
+        auto& field = newState.map.field;
+        field.set(coordToIndex(state.map, action.location), 
+            unit.first, unit.second);
+        field.erase(coordToIndex(state.map, state.selection));
+        newState.selection = action.location;
+        newState.remainingMP -= getUnitMPCost(unit.second);
+        return std::make_pair(true, newState);
       }
     }
   }
@@ -755,9 +925,10 @@ Strategy::Game::takeAction(const GameState& state, const Action& action) {
         && state.remainingAP ) {
 
       // Check if the location is in range of the unit
-      const auto& line = getLineOfSight(
-          state.map, state.selection, action.location);
-      if (!line.empty() && line.size() <= getUnitRange(unit.second) + 1) {
+      if (hasLineOfSight(state.map, state.selection, action.location)
+          && getSightRange(state.selection, action.location) 
+              <= getUnitRange(unit.second)) {
+        const auto target = readMap(state.map, action.location);
         
         // Delete whatever is at the location
         // @NOTE: This is vague to remain future-proof. There are checks
@@ -771,15 +942,17 @@ Strategy::Game::takeAction(const GameState& state, const Action& action) {
         // If update was successful, make a new state and return it
         if (attempt.first) {
 
-          // Make a new state with updated map
+          // Make a new state with updated map, taking away the unit
           auto newState = state;
           newState.map = attempt.second;
-          newState.teams = countTeams(newState.map);
+          if (isUnit(target.second)) {
+            newState.teams.removeUnit(target.first);
+            updateStatus(newState);
+          }
           newState.remainingAP -= getUnitAPCost(unit.second);
 
           // If the game is over, deselect unit
-          const auto& status = getGameStatus(newState);
-          if (status.first != GameStatus::InProgress) {
+          if (newState.status.first != GameStatus::InProgress) {
             newState.selection = Coord(-1, -1);
           }
 
@@ -822,14 +995,8 @@ Strategy::Game::takeAction(const GameState& state, const Action& action) {
     newState.remainingMP = newState.map.startingMP;
     newState.remainingAP = newState.map.startingAP;
 
-    // Count teams just to double check
-    newState.teams = countTeams(state.map);
-
     // Search for the first team that has a team number greater than current
-    auto it = std::find_if(newState.teams.begin(), newState.teams.end(),
-        [state](const std::pair<Team, unsigned int>& kvp) { 
-          return kvp.first > state.currentTeam;
-        });
+    auto it = newState.teams.upper_bound(state.currentTeam);
 
     // If a later team could not be found, go back to the first team and
     // increment the turn count
@@ -843,6 +1010,9 @@ Strategy::Game::takeAction(const GameState& state, const Action& action) {
       newState.currentTeam = it->first;
     }
 
+    // Games can run out of turns
+    updateStatus(newState);
+
     // Return the new state
     return std::make_pair(true, newState);
   }
@@ -851,6 +1021,205 @@ Strategy::Game::takeAction(const GameState& state, const Action& action) {
   return std::make_pair(false, state);
 }
 
+// Take an action on a gamestate in place
+// Follows the same rules as takeAction, but only touches what changes
+Strategy::UndoRecord
+Strategy::Game::applyAction(GameState& state, const Action& action) {
+  Trace::Scope trace("Strategy::Game::applyAction", "rules", true);
+
+  // Remember everything that isn't on the board
+  UndoRecord record;
+  record.turnNumber = state.turnNumber;
+  record.currentTeam = state.currentTeam;
+  record.selection = state.selection;
+  record.remainingMP = state.remainingMP;
+  record.remainingAP = state.remainingAP;
+  record.status = state.status;
+
+  // If the game is over, don't accept any moves
+  const auto& status = getGameStatus(state);
+  if (status.first != InProgress) { return record; }
+
+  // Change a tile, remembering what was on it
+  const auto change = [&](const Coord& c, Team team, Object object) {
+    const auto index = coordToIndex(state.map, c);
+    record.tiles[record.tileCount] = index;
+    record.previous[record.tileCount] = state.map.field.get(index);
+    record.tileCount += 1;
+    state.map.field.set(index, team, object);
+  };
+
+  // If the action is to move a unit to a location, attempt it
+  if (action.tag == Action::Tag::MoveUnit) {
+
+    // Move if the unit is friendly, there's enough MP and the destination
+    // is empty
+    const auto unit = readMap(state.map, state.selection);
+    const auto dest = readMap(state.map, action.location);
+    if (isUnit(unit.second)
+        && state.remainingMP >= getUnitMPCost(unit.second)
+        && unit.first == state.currentTeam
+        && dest.second == Object::Nothing
+        && validateCoords(state.map, action.location)
+        && validateCoords(state.map, state.selection)) {
+      change(action.location, unit.first, unit.second);
+      change(state.selection, unit.first, Object::Nothing);
+      state.selection = action.location;
+      state.remainingMP -= getUnitMPCost(unit.second);
+      record.isApplied = true;
+    }
+  }
+
+  // If the action is to attack a location
+  else if (action.tag == Action::Tag::Attack) {
+
+    // Attack if the unit is friendly and has enough AP
+    const auto unit = readMap(state.map, state.selection);
+    if (isUnit(unit.second) 
+        && state.remainingAP >= getUnitAPCost(unit.second)
+        && unit.first == state.currentTeam
+        && state.remainingAP) {
+
+      // Delete whatever is at the location if it's in range
+      if (hasLineOfSight(state.map, state.selection, action.location)
+          && getSightRange(state.selection, action.location) 
+              <= getUnitRange(unit.second)
+          && validateCoords(state.map, action.location)) {
+        const auto target = readMap(state.map, action.location);
+        change(action.location, state.currentTeam, Object::Nothing);
+
+        // Take the unit off its team's count
+        if (isUnit(target.second)) {
+          record.isUnitRemoved = true;
+          record.removedTeam = target.first;
+          state.teams.removeUnit(target.first);
+          updateStatus(state);
+        }
+        state.remainingAP -= getUnitAPCost(unit.second);
+
+        // If the game is over, deselect unit
+        if (state.status.first != GameStatus::InProgress) {
+          state.selection = Coord(-1, -1);
+        }
+        record.isApplied = true;
+      }
+    }
+  }
+
+  // If the action is to select a unit, attempt to select it
+  else if (action.tag == Action::Tag::SelectUnit) {
+    const auto unit = readMap(state.map, action.location);
+    if (unit.first == state.currentTeam && isUnit(unit.second)) {
+      state.selection = action.location;
+      record.isApplied = true;
+    }
+  }
+
+  // If the user wishes to undo selection, invalidate selection Coords
+  else if (action.tag == Action::Tag::CancelSelection) {
+    state.selection = Coord(-1, -1);
+    record.isApplied = true;
+  }
+
+  // If the team has concluded their turn
+  else if (action.tag == Action::Tag::EndTurn) {
+
+    // Invalidate selection and restore MP and AP
+    state.selection = Coord(-1, -1);
+    state.remainingMP = state.map.startingMP;
+    state.remainingAP = state.map.startingAP;
+
+    // Move on to the next team, or back to the first on a new turn
+    auto it = state.teams.upper_bound(state.currentTeam);
+    if (it == state.teams.end()) {
+      it = state.teams.begin();
+      state.turnNumber += 1;
+    }
+    if (it != state.teams.end()) {
+      state.currentTeam = it->first;
+    }
+    updateStatus(state);
+    record.isApplied = true;
+  }
+
+  // Return how to take the action back
+  return record;
+}
+
+// Take back an action applied to a state
+void
+Strategy::Game::undoAction(GameState& state, const UndoRecord& record) {
+  if (!record.isApplied) { return; }
+
+  // Put back tiles in the reverse order they were changed
+  for (unsigned int i = record.tileCount; i-- > 0;) {
+    state.map.field.set(record.tiles[i], 
+        record.previous[i].first, record.previous[i].second);
+  }
+  if (record.isUnitRemoved) {
+    state.teams.addUnit(record.removedTeam);
+  }
+
+  // Restore the rest of the state
+  state.turnNumber = record.turnNumber;
+  state.currentTeam = record.currentTeam;
+  state.selection = record.selection;
+  state.remainingMP = record.remainingMP;
+  state.remainingAP = record.remainingAP;
+  state.status = record.status;
+}
+
+// Check that applying then undoing actions agrees with takeAction
+std::pair<bool, unsigned int>
+Strategy::Game::checkApplyAndUndo(
+    const GameState& state, 
+    unsigned int actions) {
+
+  // States must match exactly, team counts included
+  const auto isSame = [](const GameState& a, const GameState& b) {
+    return a == b && a.teams == b.teams && a.status == b.status;
+  };
+
+  // Mostly play legal actions, but also try random ones so rejected
+  // actions are checked too
+  std::mt19937 generator(std::random_device{}());
+  const auto randomAction = [&](const GameState& s) {
+    const auto options = getAllPossibleActions(s);
+    if (!options.empty() && generator() % 4 != 0) {
+      return options[generator() % options.size()];
+    }
+    return Action(
+        static_cast<Action::Tag>(generator() % (Action::Tag::Attack + 1)),
+        Coord((int)(generator() % (s.map.size.x + 2)) - 1,
+            (int)(generator() % (s.map.size.y + 2)) - 1));
+  };
+
+  // Apply actions one after another, comparing each with takeAction
+  GameState current = state;
+  std::vector<GameState> history;
+  std::vector<UndoRecord> records;
+  for (unsigned int i = 0; i < actions; ++i) {
+    const auto action = randomAction(current);
+    const auto expected = takeAction(current, action);
+    history.push_back(current);
+    records.push_back(applyAction(current, action));
+    if (records.back().isApplied != expected.first
+        || !isSame(current, 
+            expected.first ? expected.second : history.back())) {
+      return std::make_pair(false, i + 1);
+    }
+  }
+
+  // Undo every action, checking each state is restored
+  for (unsigned int i = actions; i-- > 0;) {
+    undoAction(current, records[i]);
+    if (!isSame(current, history[i])) {
+      return std::make_pair(false, i + 1);
+    }
+  }
+  return std::make_pair(true, actions);
+}
+
 // Check if coordinates are valid
 bool 
 Strategy::Game::validateCoords(const Map& map, const Coord& coords) {
@@ -859,24 +1228,16 @@ Strategy::Game::validateCoords(const Map& map, const Coord& coords) {
 }
 
 // Collect the participating teams
-std::map<Strategy::Team, unsigned int> 
+Strategy::Teams 
 Strategy::Game::countTeams(const Map& map) {
 
-  // Iterate through things on the map
-  std::map<Team, unsigned int> teams;
-  for (const auto& kvp : map.field) {
+  // Count the units in each team's layer
+  Teams teams;
+  map.field.getUnits().forEach([&](std::size_t index) {
+    teams.addUnit(map.field.get(index).first);
+  });
 
-    // If the thing found is a character
-    if (isUnit(kvp.second.second)) {
-
-      // Increment the count for the found team
-      const auto& team = kvp.second.first;
-      if (teams.find(team) != teams.end()) { teams[team] += 1; }
-      else { teams[team] = 1; }
-    }
-  }
-
-  // Return the map of team counts
+  // Return the team counts
   return teams;
 }
 
@@ -885,12 +1246,7 @@ std::pair<Strategy::Team, Strategy::Object>
 Strategy::Game::readMap(
     const Map& m, 
     const Coord& pos) {
-  const unsigned int index = coordToIndex(m, pos);
-  const auto it = m.field.find(index);
-  if (it != m.field.end()) {
-    return it->second;
-  }
-  return std::make_pair(0, Object::Nothing);
+  return m.field.get(coordToIndex(m, pos));
 }
 
 // Update the map in some way
@@ -905,21 +1261,8 @@ Strategy::Game::updateMap(
   Map map = m;
   if (!validateCoords(m, pos)) { return std::make_pair(false, map); }
 
-  // Find the desired element
-  const unsigned int index = coordToIndex(m, pos);
-  const auto it = map.field.find(index);
-
-  // If the object is 'nothing', this is a call to delete
-  if (obj == Object::Nothing) {
-    if (it != map.field.end()) {
-      map.field.erase(it);
-    }
-  }
-
-  // Otherwise, insert new data into the map
-  else {
-    map.field[index] = std::make_pair(team, obj);
-  }
+  // Place the object, or delete whatever is there if it's 'nothing'
+  map.field.set(coordToIndex(m, pos), team, obj);
 
   // Return new Map
   return std::make_pair(true, map);
@@ -934,6 +1277,7 @@ Strategy::Game::getLineOfSight(
     const Map& map, 
     const Coord& from,
     const Coord& to) {
+  Trace::Scope trace("Strategy::Game::getLineOfSight", "rules", true);
 
   // Should low-line or high-line be used
   bool useHigh;
@@ -983,8 +1327,7 @@ Strategy::Game::getLineOfSight(
 
       // Check that coord is not destination or empty to return fail
       if (current != from && current != to) {
-        const auto read = readMap(map, current);
-        if (read.second != Object::Nothing) {
+        if (map.field.isOccupied(coordToIndex(map, current))) {
           return std::vector<Coord>();
         }
       }
@@ -1013,8 +1356,7 @@ Strategy::Game::getLineOfSight(
 
       // Check that coord is not destination or empty to return fail
       if (current != from && current != to) {
-        const auto read = readMap(map, current);
-        if (read.second != Object::Nothing) {
+        if (map.field.isOccupied(coordToIndex(map, current))) {
           return std::vector<Coord>();
         }
       }
@@ -1033,6 +1375,53 @@ Strategy::Game::getLineOfSight(
   return line;
 }
 
+// Check whether anything obstructs a and b
+// Looks up the tiles between them rather than drawing the line
+bool
+Strategy::Game::hasLineOfSight(
+    const Map& map,
+    const Coord& a,
+    const Coord& b) {
+
+  // The table only has lines between tiles on the map
+  if (!validateCoords(map, a) || !validateCoords(map, b)) {
+    return !getLineOfSight(map, a, b).empty();
+  }
+  return getSightTable(map.size).isClear(map.field.getOccupied(), a, b);
+}
+
+// Number of steps along the line of sight from a to b
+// Lines take one tile for every step along their longer axis
+Strategy::Range
+Strategy::Game::getSightRange(const Coord& a, const Coord& b) {
+  return std::max(std::abs(b.x - a.x), std::abs(b.y - a.y));
+}
+
+// Get the tiles between the ends of every line on a map of a size
+const Strategy::SightTable&
+Strategy::Game::getSightTable(const Coord& size) {
+
+  // Most lookups are for the same size as the last one on this thread
+  thread_local const SightTable* last = nullptr;
+  if (last != nullptr && last->getSize() == size) { return *last; }
+
+  // Otherwise find the table, building it by drawing lines on an empty map
+  // Tables are never freed, so references to them stay valid
+  static std::mutex mutex;
+  static std::map<std::pair<int, int>, std::unique_ptr<SightTable>> tables;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& table = tables[std::make_pair(size.x, size.y)];
+  if (!table) {
+    Map empty;
+    empty.resize(size);
+    table.reset(new SightTable(size, [&](const Coord& a, const Coord& b) {
+      return getLineOfSight(empty, a, b);
+    }));
+  }
+  last = table.get();
+  return *last;
+}
+
 // Get all objects in line of sight (used for targeting)
 std::vector<std::pair<Strategy::Coord, Strategy::Range>> 
 Strategy::Game::getObjectsInSight(const Map& map, const Coord& u) {
@@ -1051,13 +1440,8 @@ Strategy::Game::getObjectsInSight(const Map& map, const Coord& u) {
       const auto& object = kvp.second.second;
 
       // If this is an enemy unit, record if it's in sight or not
-      if (object != Object::Nothing) {
-        const auto& line = getLineOfSight(
-            map, u, pos);
-        if (!line.empty()) {
-          const Range r = std::max(0, (int)line.size() - 1);
-          units.push_back(std::make_pair(pos, r));
-        }
+      if (object != Object::Nothing && hasLineOfSight(map, u, pos)) {
+        units.push_back(std::make_pair(pos, getSightRange(u, pos)));
       }
     }
   }
@@ -1079,21 +1463,14 @@ Strategy::Game::getUnitsInSight(const Map& map, const Coord& u) {
       && isUnit(location.second)) {
 
     // Iterate through every enemy and determine if they're in line of sight
-    for (const auto& kvp : map.field) {
-      const auto& pos = indexToCoord(map, kvp.first);
-      const auto& team = kvp.second.first;
-      const auto& object = kvp.second.second;
-
-      // If this is an enemy unit, record if it's in sight or not
-      if (team != location.first && isUnit(object)) {
-        const auto& line = getLineOfSight(
-            map, u, pos);
-        if (!line.empty()) {
-          const Range r = std::max(0, (int)line.size() - 1);
-          units.push_back(std::make_pair(pos, r));
-        }
+    auto enemies = map.field.getUnits();
+    enemies.remove(map.field.getTeamUnits(location.first));
+    enemies.forEach([&](std::size_t index) {
+      const auto& pos = indexToCoord(map, index);
+      if (hasLineOfSight(map, u, pos)) {
+        units.push_back(std::make_pair(pos, getSightRange(u, pos)));
       }
-    }
+    });
   }
 
   // Return what was discovered
@@ -1111,37 +1488,32 @@ Strategy::Game::getAlliesAndEnemiesInRange(
   std::set<unsigned int> alliesInRangeOfEnemies;
   std::set<unsigned int> enemiesInRangeOfAllies;
 
-  // Iterate through all units
-  for (const auto& object : state.map.field) {
-
-    // Only iterate through allied units
-    const auto& pos = indexToCoord(state.map, object.first);
-    const auto& unit = object.second;
-    if (unit.first == team && isUnit(unit.second)) {
+  // Iterate through allied units
+  state.map.field.getTeamUnits(team).forEach([&](std::size_t index) {
 
-      // Check to see if any enemies are in sight
-      const auto& unitRange = getUnitRange(unit.second);
-      const auto& enemies = getUnitsInSight(state.map, pos);
+    // Check to see if any enemies are in sight
+    const auto& pos = indexToCoord(state.map, index);
+    const auto& unitRange = getUnitRange(state.map.field.get(index).second);
+    const auto& enemies = getUnitsInSight(state.map, pos);
 
-      // Check to see if the ally is in range of an enemy
-      for (unsigned int i = 0; i < enemies.size(); ++i) {
-        const auto& enemyAndDistance = enemies[i];
-        const auto& object = readMap(state.map, enemyAndDistance.first);
-        const auto& enemyRange = getUnitRange(object.second);
+    // Check to see if the ally is in range of an enemy
+    for (unsigned int i = 0; i < enemies.size(); ++i) {
+      const auto& enemyAndDistance = enemies[i];
+      const auto& object = readMap(state.map, enemyAndDistance.first);
+      const auto& enemyRange = getUnitRange(object.second);
 
-        // If the enemy is NOT in range of the current unit, apply penalty
-        if (enemyAndDistance.second <= unitRange) {
-          enemiesInRangeOfAllies.insert(
-              coordToIndex(state.map, enemyAndDistance.first));
-        }
+      // If the enemy is NOT in range of the current unit, apply penalty
+      if (enemyAndDistance.second <= unitRange) {
+        enemiesInRangeOfAllies.insert(
+            coordToIndex(state.map, enemyAndDistance.first));
+      }
 
-        // If the selection or ally is in range of an enemy, apply penalties
-        if (enemyAndDistance.second <= enemyRange) {
-          alliesInRangeOfEnemies.insert(coordToIndex(state.map, pos));
-        }
+      // If the selection or ally is in range of an enemy, apply penalties
+      if (enemyAndDistance.second <= enemyRange) {
+        alliesInRangeOfEnemies.insert(coordToIndex(state.map, pos));
       }
     }
-  }
+  });
 
   // Return the amount of allies / enemies in range
   return std::make_pair(
@@ -1216,14 +1588,12 @@ Strategy::Game::getPossibleMoves(const GameState& state) {
     // Check if the moves are valid AND if they're unoccupied
     for (const auto& m : possible) {
       const auto pos = state.selection + m;
-      if (validateCoords(state.map, pos)) {
-        const auto& entity = readMap(state.map, pos);
-        if (entity.second == Object::Nothing) {
-          Action action;
-          action.tag = Action::Tag::MoveUnit;
-          action.location = pos;
-          actions.push_back(action);
-        }
+      if (validateCoords(state.map, pos)
+          && !state.map.field.isOccupied(coordToIndex(state.map, pos))) {
+        Action action;
+        action.tag = Action::Tag::MoveUnit;
+        action.location = pos;
+        actions.push_back(action);
       }
     }
   }
@@ -1300,19 +1670,14 @@ Strategy::Game::getPossibleAttacks(const GameState& state) {
             // Otherwise, use line of sight to determine whether to add it
             else {
 
-              // Get line of sight
-              const auto& line = getLineOfSight(state.map, unitPos, pos);
+              // If line of sight was achieved
+              if (hasLineOfSight(state.map, unitPos, pos)) {
 
-              // If the line isn't empty, line of sight was achieved
-              if (!line.empty()) {
-
-                // Add all tiles in range to the set to stop repeats
-                for (int r = 0; r <= range && r < line.size(); ++r) {
-                  inSight.insert(coordToIndex(state.map, Coord(i, j)));
-                }
+                // Add the tile to the set to stop repeats
+                inSight.insert(coordToIndex(state.map, pos));
 
                 // Add this location if in range
-                if (line.size() <= range + 1) {
+                if (getSightRange(unitPos, pos) <= range) {
                   actions.push_back(action);
                 }
               }
@@ -1342,39 +1707,33 @@ Strategy::Game::getAllPossibleActions(const GameState& state) {
 
   // Add possible selections
   unsigned int selections = 0;
-  for (const auto& kvp : state.map.field) {
-
-    // Get data of object
-    const auto& pos = indexToCoord(state.map, kvp.first);
-    const auto& team = kvp.second.first;
-    const auto& object = kvp.second.second;
-
-    // If object is an allied unit and has a valid coordinate
-    if (validateCoords(state.map, pos) 
-        && team == state.currentTeam 
-        && isUnit(object)) {
+  const auto& allies = state.map.field.getTeamUnits(state.currentTeam);
+  allies.forEach([&](std::size_t index) {
 
-      // Prepare an Action
-      Action action;
+    // Skip allied units without a valid coordinate
+    const auto& pos = indexToCoord(state.map, index);
+    if (!validateCoords(state.map, pos)) { return; }
 
-      // Add a selection action if it's a different unit
-      if (pos != state.selection) {
-        action.tag = Action::Tag::SelectUnit;
-        action.location = pos;
-        selections += 1;
-      }
+    // Prepare an Action
+    Action action;
 
-      // Add a deselection action
-      // @NOTE: I don't know why an AI would do this
-      else {
-        action.tag = Action::Tag::CancelSelection;
-        action.location = Coord(-1, -1);
-      }
+    // Add a selection action if it's a different unit
+    if (pos != state.selection) {
+      action.tag = Action::Tag::SelectUnit;
+      action.location = pos;
+      selections += 1;
+    }
 
-      // Add action tohas ended
-      actions.push_back(action);
+    // Add a deselection action
+    // @NOTE: I don't know why an AI would do this
+    else {
+      action.tag = Action::Tag::CancelSelection;
+      action.location = Coord(-1, -1);
     }
-  }
+
+    // Add action tohas ended
+    actions.push_back(action);
+  });
 
   // Add moves to the list
   const auto& moves = getPossibleMoves(state);
@@ -1404,46 +1763,7 @@ Strategy::Game::hasTurnEnded(const GameState& a, const GameState& b) {
 // Check if there's a winning team and retrieve it if so
 std::pair<Strategy::GameStatus, Strategy::Team> 
 Strategy::Game::getGameStatus(const GameState& state) {
-
-  // Check for games that go on too long
-  const unsigned int maxTurns = state.map.size.x * state.map.size.y * 2;
-  if (state.turnNumber > maxTurns) {
-
-    // Find most amount of units
-    unsigned int mostUnits = 0;
-    unsigned int teamsWithMostUnits = 0;
-    Team winningTeam = Team(0);
-    for (const auto& kvp : state.teams) {
-      if (kvp.second > mostUnits) {
-        winningTeam = kvp.first;
-        mostUnits = kvp.second;
-        teamsWithMostUnits = 1;
-      }
-      else if (kvp.second == mostUnits) {
-        teamsWithMostUnits += 1;
-      }
-    }
-
-    // If there's a single team with the most, they win
-    return std::make_pair(
-        teamsWithMostUnits == 1 ? 
-            GameStatus::Won : GameStatus::Tied,
-        winningTeam);
-  }
-
-  // Render win text if there's only one team left
-  if (state.teams.size() <= 1) {
-    if (state.teams.size() == 1) {
-      const auto team = state.teams.begin()->first;
-      return std::make_pair(GameStatus::Won, team);
-    }
-    else {
-      return std::make_pair(GameStatus::Tied, Team(0));
-    }
-  }
-
-  // The game hasn't finished so return InProgress
-  return std::make_pair(GameStatus::InProgress, Team(0));
+  return state.status;
 }
 
 // Translate coords into map index
@@ -1514,6 +1834,7 @@ Strategy::Game::getDefaultUnitPlacement(const Map& map) {
 // Recursively push states by querying AI controllers
 void
 Strategy::Game::continueGame() {
+  Trace::Scope trace("Strategy::Game::continueGame", "game");
 
   // Prepare to query controller for what actions to perform
   if (!isAIThinking_) { 
@@ -1535,6 +1856,7 @@ Strategy::Game::continueGame() {
 
     // Check what controller is currently playing
     const auto& controller = getController(state.currentTeam);
+    aiDecisionStart_ = std::chrono::steady_clock::now();
 
     // If the controller is HUMAN, do nothing
     if (controller == Controller::Type::Human) {
@@ -1577,7 +1899,12 @@ Strategy::Game::continueGame() {
     // Check if the decision has been made
     const bool isReady = aiDecision_.wait_for(std::chrono::seconds(0))
         == std::future_status::ready;
-    if (isReady) {
+
+    // Timing threads doesn't decide anything, so keep the timings instead
+    if (isReady && isTimingThreads_) {
+      finishTimingThreads();
+    }
+    else if (isReady) {
 
       // Retrieve the latest game state
       const auto statePair = getState(states_.size() - 1);
@@ -1586,6 +1913,25 @@ Strategy::Game::continueGame() {
 
       // If AI successfully made moves, update and continue
       isAIThinking_ = false;
+      aiDecisionTime_ = std::chrono::duration<float, std::milli>(
+          std::chrono::steady_clock::now() - aiDecisionStart_).count();
+
+      // Keep the search's measurements, now the AI's thread is done
+      // Append them to the log if asked to
+      if (thinkingAI_ != nullptr) {
+        searchStats_ = thinkingAI_->getSearchStats();
+        searchStatsAI_ = thinkingAI_;
+      }
+      if (isLoggingSearchStats_ && thinkingAI_ != nullptr) {
+        std::ofstream file("search_stats.jsonl", std::ios_base::app);
+        file << "{\"team\":" << state.currentTeam
+            << ",\"controller\":\""
+            << Controller::typeToString(getController(state.currentTeam))
+            << "\",\"decisionMs\":" << aiDecisionTime_
+            << ",\"search\":" << searchStats_.toJson()
+            << "}\n";
+      }
+      thinkingAI_ = nullptr;
       auto currentState = state;
       auto attempt = aiDecision_.get();
       bool failed = attempt.second.empty() || !attempt.first;
@@ -1623,6 +1969,93 @@ Strategy::Game::continueGame() {
   }
 }
 
+// Abandon the AI's current decision and free its memory
+void
+Strategy::Game::stopAI() {
+
+  // Nothing to do if the AI isn't thinking
+  if (!isAIThinking_) { return; }
+
+  // Ask the search to stop, and leave it to give up in the background
+  // Its memory is freed once it has, by collectCancelledAI
+  aiStopToken_.requestStop();
+  if (aiDecision_.valid()) {
+    cancelledDecisions_.emplace_back(aiDecision_.share(), thinkingAI_);
+  }
+  thinkingAI_ = nullptr;
+  isAIThinking_ = false;
+  isTimingThreads_ = false;
+  pendingTimings_.reset();
+  Console::log("AI decision cancelled.");
+}
+
+// Forget abandoned decisions that have finished winding down
+void
+Strategy::Game::collectCancelledAI() {
+  auto it = cancelledDecisions_.begin();
+  while (it != cancelledDecisions_.end()) {
+    const bool isReady = it->first.wait_for(std::chrono::seconds(0))
+        == std::future_status::ready;
+    if (!isReady) { 
+      ++it; 
+      continue; 
+    }
+
+    // Free whatever memory the search was using, unless the AI has since
+    // been asked to think again
+    AI::BaseCase* ai = it->second;
+    it = cancelledDecisions_.erase(it);
+    if (ai != nullptr && !isAIBusy(ai)) {
+      ai->release();
+    }
+  }
+}
+
+// Check whether an AI is thinking, or still winding down
+bool
+Strategy::Game::isAIBusy(const AI::BaseCase* ai) const {
+  if (isAIThinking_ && thinkingAI_ == ai) { return true; }
+  return std::any_of(cancelledDecisions_.begin(), cancelledDecisions_.end(),
+      [ai](const auto& cancelled) { return cancelled.second == ai; });
+}
+
+// Time parallel A* against threads on a state in place of a decision
+void
+Strategy::Game::timeAIThreads(AI::BaseCase* ai, const GameState& state) {
+  const unsigned int most = std::max(4u, std::thread::hardware_concurrency());
+  auto timings = std::make_shared<std::vector<AI::BaseCase::ThreadTiming>>();
+  pendingTimings_ = timings;
+  isTimingThreads_ = true;
+  isAIThinking_ = true;
+  thinkingAI_ = ai;
+  aiStopToken_ = Controller::StopToken();
+  aiDecision_ = std::async(std::launch::async,
+      [ai, state, most, timings, stop = aiStopToken_]() {
+        Trace::nameThread("AI");
+        Trace::Scope trace("Time parallel A*", "ai");
+        *timings = ai->timeThreads(state, most, stop);
+        return std::make_pair(false, std::stack<Action>());
+      });
+}
+
+// Keep the timings once they're ready
+void
+Strategy::Game::finishTimingThreads() {
+  aiDecision_.get();
+  threadTimings_ = *pendingTimings_;
+  pendingTimings_.reset();
+  isTimingThreads_ = false;
+  isAIThinking_ = false;
+  thinkingAI_ = nullptr;
+  Console::log("Timed parallel A* on %u cores.", 
+      std::thread::hardware_concurrency());
+  for (const auto& timing : threadTimings_) {
+    Console::log("Parallel A* on %u threads: %.1f ms, %u states (%.2fx)", 
+        timing.threads, timing.milliseconds, timing.statesProcessed, 
+        threadTimings_.front().milliseconds / timing.milliseconds);
+  }
+}
+
 // Clear future states when things happen
 void
 Strategy::Game::clearFutureStates() {
@@ -1642,6 +2075,9 @@ Strategy::Game::viewLatestState() {
 void 
 Strategy::Game::resetGame() {
 
+  // Abandon anything the AI was thinking about
+  stopAI();
+
   // Report that we're starting a new game
   Console::log("Game has been reset.");
 
@@ -1654,6 +2090,7 @@ Strategy::Game::resetGame() {
   state.currentTeam = it != state.teams.end() ? it->first : -1;
   state.remainingMP = state.map.startingMP;
   state.remainingAP = state.map.startingAP;
+  updateStatus(state);
   pushState(state);
 
   // Set current state to the most up-to-date state
@@ -1797,51 +2234,60 @@ Strategy::Game::recalculatePath() {
     return;
   }
 
-  // Make a state with near-infinite movement points for pathfinding
-  auto infinState = state;
-  infinState.remainingMP = INT_MAX;
+  // Work out the moves to every tile if the state has changed
+  recalculateMoveField(state);
 
-  // Employ the use of AStar to find a path
-  Controller::AStar<GameState, Action, unsigned int> pather;
-  auto attempt = pather(
-      infinState,
-      0,
-      UINT_MAX,
-      getPossibleMoves,
+  // Exit if the hovered tile can't be reached
+  const int target = coordToIndex(state.map, hoveredTile_);
+  if (moveDistance_[target] < 0) { return; }
 
-      // IsStateEndpoint (is the tile = to the hovered tile)
-      [this](const GameState& a, const GameState& b) {
-        return b.selection == hoveredTile_;
-      },
-
-      // Heuristic (just do pythagoras to get distance)
-      [this](const GameState& s) {
-        const auto l = s.selection.x - hoveredTile_.x;
-        const auto h = s.selection.y - hoveredTile_.y;
-        const auto hyp = std::sqrt(l * l + h * h);
-        return static_cast<unsigned int>(std::ceil(hyp));
-      },
+  // Walk back from the hovered tile to the unit, accumilating the cost
+  const auto unitMPCost = getUnitMPCost(unit.second);
+  for (int i = target; moveParent_[i] >= 0; i = moveParent_[i]) {
+    path_.push_back(Action(Action::Tag::MoveUnit, 
+        indexToCoord(state.map, i)));
+    // @TODO: Take environment into account here
+    mpCost_ += unitMPCost;
+  }
+  std::reverse(path_.begin(), path_.end());
+}
 
-      // Weigh action (every move is 1 MP)
-      [](const GameState& start, const GameState& a, const GameState& b, 
-          const Action& action) {
-        return 1;
-      },
-      takeAction,
-      std::less<unsigned int>()
-  );
+// Work out the moves to every tile from the selection if necessary
+void
+Strategy::Game::recalculateMoveField(const GameState& state) {
 
-  // If the path worked
-  if (attempt.first) {
+  // Keep the last distances if they were for the same state
+  const auto key = hashState(state);
+  if (key == moveFieldKey_ && !moveDistance_.empty()) { return; }
+  moveFieldKey_ = key;
 
-    // Unwind stack and accumilate the path's cost
-    const auto unitMPCost = getUnitMPCost(unit.second);
-    while (!attempt.second.empty()) {
-      const auto& action = attempt.second.top();
-      path_.push_back(action);
-      // @TODO: Take environment into account here
-      mpCost_ += unitMPCost;
-      attempt.second.pop();
+  // Prepare to calculate new distances
+  const auto& map = state.map;
+  const unsigned int tiles = map.size.x * map.size.y;
+  moveDistance_.assign(tiles, -1);
+  moveParent_.assign(tiles, -1);
+  if (!validateCoords(map, state.selection)) { return; }
+
+  // Every move costs the same, so search breadth first from the selection
+  // You can move up, down, left and right into empty tiles
+  const auto possible = std::vector<Coord>
+      { Coord(1, 0), Coord(0, -1), Coord(-1, 0), Coord(0, 1) };
+  std::vector<unsigned int> frontier = { coordToIndex(map, state.selection) };
+  moveDistance_[frontier.front()] = 0;
+  for (unsigned int i = 0; i < frontier.size(); ++i) {
+    const auto current = frontier[i];
+    const auto pos = indexToCoord(map, current);
+    for (const auto& m : possible) {
+      const auto next = pos + m;
+      if (!validateCoords(map, next)) { continue; }
+      const auto index = coordToIndex(map, next);
+      if (moveDistance_[index] >= 0 
+          || readMap(map, next).second != Object::Nothing) {
+        continue;
+      }
+      moveDistance_[index] = moveDistance_[current] + 1;
+      moveParent_[index] = current;
+      frontier.push_back(index);
     }
   }
 }
@@ -1939,6 +2385,20 @@ Strategy::Game::createOrUseAI(const GameState& state, bool use) {
     useAIFromIndex<AI::CaseFour>(index, state, use);
   }
 
+  // Case studies deciding with beam search:
+  else if (controller == Controller::Type::BeamOne) {
+    useAIFromIndex<AI::Beam<AI::CaseOne>>(index, state, use);
+  }
+  else if (controller == Controller::Type::BeamTwo) {
+    useAIFromIndex<AI::Beam<AI::CaseTwo>>(index, state, use);
+  }
+  else if (controller == Controller::Type::BeamThree) {
+    useAIFromIndex<AI::Beam<AI::CaseThree>>(index, state, use);
+  }
+  else if (controller == Controller::Type::BeamFour) {
+    useAIFromIndex<AI::Beam<AI::CaseFour>>(index, state, use);
+  }
+
   // Report error if case couldn't be found
   else {
     Console::log("[Error] Couldn't create AI %u for controller %s",
@@ -1993,6 +2453,203 @@ Strategy::Game::logAction(const GameState& state, const Action& action) {
   }
 }
 
+// Show controls and histograms for replaying a recorded search
+void
+Strategy::Game::debugSearchReplay(const GameState& state) {
+  static const char* filename = "search_log.bin";
+
+  // Actions are stored as their tag and location, and any unknown tag
+  // means the file can't be trusted
+  const auto writeAction = [](std::ostream& out, const Action& action) {
+    const std::int32_t fields[] = {
+        action.tag, action.location.x, action.location.y};
+    out.write(reinterpret_cast<const char*>(fields), sizeof(fields));
+  };
+  const auto readAction = [](std::istream& in, Action& action) {
+    std::int32_t fields[3] = {};
+    if (!in.read(reinterpret_cast<char*>(fields), sizeof(fields))
+        || fields[0] < Action::Tag::EndTurn 
+        || fields[0] > Action::Tag::Attack) {
+      return false;
+    }
+    action = Action((Action::Tag)fields[0], Coord(fields[1], fields[2]));
+    return true;
+  };
+
+  // Allow the current team's AI to record its decisions
+  const auto it = aiFunctors_.find(getAIIndex(state.currentTeam));
+  if (it != aiFunctors_.end() && it->second != nullptr) {
+    auto& ai = *it->second;
+    bool isRecording = ai.isRecordingSearch();
+    if (ImGui::Checkbox("Record decisions (A* only)", &isRecording)) {
+      ai.setRecordingSearch(isRecording);
+    }
+
+    // The log is only safe to read once the AI has stopped thinking
+    const auto& log = ai.getSearchLog();
+    if (!isAIBusy(&ai) && !log.empty()) {
+      ImGui::Text("Last decision expanded %zu states.", log.size());
+      if (ImGui::Button("Replay")) { prepareReplay(log); }
+      ImGui::SameLine();
+      if (ImGui::Button("Save")) {
+        std::ofstream file(filename, std::ios_base::binary);
+        log.save(file, writeAction);
+        Console::log("Saved search of %zu states to %s.", 
+            log.size(), filename);
+      }
+    }
+  }
+  else {
+    ImGui::Text("The current team has no AI to record.");
+  }
+
+  // Allow searches to be replayed without running them again
+  if (ImGui::Button("Load saved search")) {
+    std::ifstream file(filename, std::ios_base::binary);
+    Controller::SearchLog<Action> log;
+    if (file && log.load(file, readAction)) {
+      prepareReplay(log);
+      Console::log("Loaded search of %zu states from %s.", 
+          log.size(), filename);
+    }
+    else {
+      Console::log("[Error] Couldn't load a search from %s.", filename);
+    }
+  }
+  if (replay_.empty()) { return; }
+
+  // Step through the expansions, playing them back if asked to
+  const int count = (int)replay_.size();
+  ImGui::Separator();
+  ImGui::PushItemWidth(80.f);
+  ImGui::Checkbox("Play", &isReplayPlaying_);
+  ImGui::SameLine();
+  ImGui::InputInt("Steps per frame", &replaySpeed_, 1, 10);
+  replaySpeed_ = std::max(replaySpeed_, 1);
+  ImGui::PopItemWidth();
+  if (isReplayPlaying_) {
+    replayStep_ = std::min(count, replayStep_ + replaySpeed_);
+    isReplayPlaying_ = replayStep_ < count;
+  }
+  ImGui::SliderInt("Expansion", &replayStep_, 0, count);
+
+  // Describe the latest expansion
+  const auto& entries = replay_.getEntries();
+  if (replayStep_ > 0) {
+    const auto& entry = entries[replayStep_ - 1];
+    ImGui::Text("State %u from %d, at depth %u", entry.node, 
+        entry.parent == Controller::invalidNode ? -1 : (int)entry.parent,
+        entry.depth);
+    ImGui::Text("Reached by: %s (%d, %d)", actionToString(entry.action), 
+        entry.action.location.x, entry.action.location.y);
+    ImGui::Text("g: %.1f, h: %.1f%s", entry.g, entry.h, 
+        entry.isEndpoint ? " (endpoint)" : "");
+  }
+
+  // Count the expansions so far by the action reaching them and depth
+  float tags[5] = {};
+  std::vector<float> depths;
+  for (int i = 0; i < replayStep_; ++i) {
+    const auto& entry = entries[i];
+    if (entry.parent != Controller::invalidNode
+        && entry.action.tag >= 0 && entry.action.tag < IM_ARRAYSIZE(tags)) {
+      tags[entry.action.tag] += 1.f;
+    }
+    if (entry.depth >= depths.size()) { depths.resize(entry.depth + 1); }
+    depths[entry.depth] += 1.f;
+  }
+  ImGui::Text("By action (end, deselect, select, move, attack):");
+  ImGui::PlotHistogram("##Actions", tags, IM_ARRAYSIZE(tags), 0, NULL, 
+      0.f, FLT_MAX, ImVec2(0.f, 60.f));
+  ImGui::Text("By depth:");
+  if (!depths.empty()) {
+    ImGui::PlotHistogram("##Depths", depths.data(), (int)depths.size(), 0, 
+        NULL, 0.f, FLT_MAX, ImVec2(0.f, 60.f));
+  }
+}
+
+// Start replaying a search, working out what each state had selected
+void
+Strategy::Game::prepareReplay(const Controller::SearchLog<Action>& log) {
+  replay_ = log;
+  replayStep_ = 0;
+  isReplayPlaying_ = false;
+
+  // The selection the decision started with is kept in the context
+  Coord start(-1, -1);
+  std::istringstream(log.getContext()) >> start.x >> start.y;
+
+  // Parents are always expanded before their children, so each state's
+  // selection follows from its parent's and the action taken
+  std::unordered_map<Controller::NodeId, Coord> selections;
+  replaySelections_.clear();
+  replaySelections_.reserve(log.size());
+  for (const auto& entry : log.getEntries()) {
+    Coord selection = start;
+    const auto parent = selections.find(entry.parent);
+    if (parent != selections.end()) { selection = parent->second; }
+    if (entry.parent != Controller::invalidNode) {
+      switch (entry.action.tag) {
+        case Action::Tag::SelectUnit:
+        case Action::Tag::MoveUnit:
+          selection = entry.action.location;
+          break;
+        case Action::Tag::CancelSelection:
+        case Action::Tag::EndTurn:
+          selection = Coord(-1, -1);
+          break;
+        default: break;
+      }
+    }
+    selections[entry.node] = selection;
+    replaySelections_.push_back(selection);
+  }
+}
+
+// Shade tiles by how often the replayed search expanded their selection
+void
+Strategy::Game::renderReplay(sf::RenderWindow& window, const GameState& state) {
+
+  // Count the selections of the states expanded so far
+  std::vector<unsigned int> counts(state.map.size.x * state.map.size.y, 0);
+  unsigned int most = 0;
+  for (int i = 0; i < replayStep_; ++i) {
+    const auto& selection = replaySelections_[i];
+    if (!validateCoords(state.map, selection)) { continue; }
+    auto& count = counts[coordToIndex(state.map, selection)];
+    count += 1;
+    most = std::max(most, count);
+  }
+
+  // Draw hotter tiles more opaquely
+  auto rect = sf::RectangleShape(sf::Vector2f(tileLength_, tileLength_));
+  for (unsigned int i = 0; i < counts.size(); ++i) {
+    if (counts[i] == 0) { continue; }
+    const auto c = indexToCoord(state.map, i);
+    rect.setFillColor(sf::Color(255, 160, 0, 
+        (sf::Uint8)(30 + 150 * counts[i] / most)));
+    rect.setPosition(sf::Vector2f(
+        left_ + c.x * tileLength_,
+        top_ + c.y * tileLength_));
+    window.draw(rect);
+  }
+
+  // Outline the tile acted on by the latest expansion
+  if (replayStep_ > 0) {
+    const auto& location = replay_.getEntries()[replayStep_ - 1]
+        .action.location;
+    if (validateCoords(state.map, location)) {
+      rect.setFillColor(sf::Color::Transparent);
+      rect.setOutlineColor(sf::Color::White);
+      rect.setOutlineThickness(-2.f);
+      rect.setPosition(sf::Vector2f(
+          left_ + location.x * tileLength_,
+          top_ + location.y * tileLength_));
+      window.draw(rect);
+    }
+  }
+}
+
 // Adjust graphics for current game size
 void
 Strategy::Game::resizeGame() {
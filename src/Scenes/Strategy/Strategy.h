@@ -5,6 +5,7 @@
 #define STRATEGY_H
 
 #include <future>
+#include <chrono>
 #include <thread>
 #include <fstream>
 #include <istream>
@@ -13,6 +14,10 @@
 #include <math.h>
 #include <cmath>
 #include <climits>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
 
 #include "../../Scene.h"
 #include "../../Resources.h"
@@ -25,17 +30,11 @@
 #include "GameState.h"
 #include "Map.h"
 #include "Action.h"
+#include "SightTable.h"
 
 // Encapsulate Strategy related classes
 namespace Strategy {
 
-  // Enum to measure if the game is over
-  enum GameStatus {
-    InProgress,
-    Won,
-    Tied
-  };
-
   // Game scene for strategy game
   class Game : public Scene {
     public:
@@ -60,6 +59,12 @@ namespace Strategy {
       // Whenever the scene is re-shown, ensure graphics are correct
       void onShow() override;
 
+      // Stop the AI from thinking when the scene is hidden
+      void onHide() override;
+
+      // Stop the AI from thinking when the app quits
+      void onQuit() override;
+
       // Add a menu entry to the debug menu
       void addDebugMenuEntries() override;
 
@@ -78,13 +83,28 @@ namespace Strategy {
           const GameState& state,
           const Action& action);
 
+      // Take an action on a gamestate in place, the same way as takeAction
+      // The record says whether it was taken and how to take it back
+      static UndoRecord applyAction(GameState& state, const Action& action);
+
+      // Take back an action applied to a state, restoring it exactly
+      // Actions must be undone in the reverse order they were applied
+      static void undoAction(GameState& state, const UndoRecord& record);
+
+      // Check that applying then undoing actions agrees with takeAction
+      // Plays random actions from a state and returns whether every one
+      // matched, and how many actions were checked
+      static std::pair<bool, unsigned int> checkApplyAndUndo(
+          const GameState& state,
+          unsigned int actions);
+
       // Check if coordinates are valid
       static bool validateCoords(
           const Map& map, 
           const Coord& coords);
 
       // Collect the participating teams
-      static std::map<Team, unsigned int> countTeams(const Map& map);
+      static Teams countTeams(const Map& map);
 
       // Get an object on the play field
       static std::pair<Team, Object> readMap(
@@ -105,6 +125,21 @@ namespace Strategy {
           const Coord& a,
           const Coord& b);
 
+      // Check whether anything obstructs a and b, the same as getLineOfSight
+      // returning a line, but without building it
+      static bool hasLineOfSight(
+          const Map& map,
+          const Coord& a,
+          const Coord& b);
+
+      // Number of steps along the line of sight from a to b, which is one
+      // less than the length of the line getLineOfSight returns
+      static Range getSightRange(const Coord& a, const Coord& b);
+
+      // Get the tiles between the ends of every line on a map of a size
+      // Tables are built the first time a size is used and kept for good
+      static const SightTable& getSightTable(const Coord& size);
+
       // Get all objects in line of sight (used for targeting)
       static std::vector<std::pair<Coord, Range>> getObjectsInSight(
           const Map& map,
@@ -137,6 +172,7 @@ namespace Strategy {
       static bool hasTurnEnded(const GameState& a, const GameState& b);
 
       // Check if there's a winning team and retrieve it if so
+      // The status is kept in the state, so this doesn't work anything out
       static std::pair<GameStatus, Team> getGameStatus(const GameState& state);
 
       // Translate coords into map index
@@ -171,9 +207,46 @@ namespace Strategy {
       std::future<std::pair<bool, std::stack<Action>>> aiDecision_;
       bool isAIThinking_ = false;
 
+      // Used to abandon the decision the AI is currently making
+      Controller::StopToken aiStopToken_;
+      AI::BaseCase* thinkingAI_ = nullptr;
+
+      // Abandoned decisions still winding down, and the AI making each
+      // They're checked every update rather than waited for
+      std::vector<std::pair<
+          std::shared_future<std::pair<bool, std::stack<Action>>>,
+          AI::BaseCase*>> cancelledDecisions_;
+
+      // Time taken by the AI's last decision, to compare settings with
+      std::chrono::steady_clock::time_point aiDecisionStart_;
+      float aiDecisionTime_ = 0.f;
+
+      // Decision times of parallel A* with different numbers of threads
+      // They're timed in place of a decision, and kept once it's ready
+      std::vector<AI::BaseCase::ThreadTiming> threadTimings_;
+      std::shared_ptr<std::vector<AI::BaseCase::ThreadTiming>> 
+          pendingTimings_;
+      bool isTimingThreads_ = false;
+
+      // Search stats of the last finished decision, and the AI that made it
+      // Copied once the decision is ready, as the AI's thread writes them
+      Controller::SearchStats searchStats_;
+      const AI::BaseCase* searchStatsAI_ = nullptr;
+
+      // Should every decision's search stats be appended to a file
+      bool isLoggingSearchStats_ = false;
+
       // Player pathfinding route
       std::vector<Action> path_;
 
+      // Moves for the selected unit to reach each tile, -1 if it can't,
+      // and the tile each was reached from
+      std::vector<int> moveDistance_;
+      std::vector<int> moveParent_;
+
+      // Hash of the state the move distances were worked out for
+      std::uint64_t moveFieldKey_ = 0;
+
       // The grid of the playing field to draw
       sf::VertexArray grid_;
 
@@ -184,6 +257,9 @@ namespace Strategy {
       // Should turns or states be recorded?
       bool isRecordingStates_ = true;
 
+      // Result of the last check of applyAction against takeAction
+      std::string applyUndoCheck_;
+
       // Should a unit move or attack
       bool isInAttackMode_;
 
@@ -212,6 +288,16 @@ namespace Strategy {
       // AI viewer variables
       bool enableAIViewer_ = true;
 
+      // Search replay variables
+      // A recorded decision, the selection of each state it expanded and
+      // how many expansions have been played so far
+      bool enableSearchReplay_ = false;
+      Controller::SearchLog<Action> replay_;
+      std::vector<Coord> replaySelections_;
+      int replayStep_ = 0;
+      int replaySpeed_ = 1;
+      bool isReplayPlaying_ = false;
+
       ///////////////////////////////////////////
       // PRIVATE PURE FUNCTIONS:
       // - Functions without side effects
@@ -229,6 +315,21 @@ namespace Strategy {
       // Recursively push states by querying AI controllers
       void continueGame();
 
+      // Abandon the AI's current decision and free its memory
+      void stopAI();
+
+      // Forget abandoned decisions that have finished winding down
+      void collectCancelledAI();
+
+      // Check whether an AI is thinking, or still winding down
+      bool isAIBusy(const AI::BaseCase* ai) const;
+
+      // Time parallel A* against threads on a state in place of a decision
+      void timeAIThreads(AI::BaseCase* ai, const GameState& state);
+
+      // Keep the timings once they're ready
+      void finishTimingThreads();
+
       // Clear future states when things happen
       void clearFutureStates();
 
@@ -261,6 +362,9 @@ namespace Strategy {
       // Calculate the path_ variable from selected to hoveredTile_
       void recalculatePath();
 
+      // Work out the moves to every tile from the selection if necessary
+      void recalculateMoveField(const GameState& state);
+
       // Recalculate the line of sight set
       void recalculateLineOfSight();
 
@@ -301,9 +405,37 @@ namespace Strategy {
         // Use it if desired and possible
         if (use && aiPtr != nullptr) {
           isAIThinking_ = true;
-          auto& ai = *aiPtr;
+          thinkingAI_ = aiPtr;
+          aiStopToken_ = Controller::StopToken();
+          const std::string controller = 
+              Controller::typeToString(getController(s.currentTeam));
+
+          // An AI can only make one decision at a time, so wait for any it
+          // abandoned to wind down first
+          std::shared_future<std::pair<bool, std::stack<Action>>> previous;
+          for (const auto& cancelled : cancelledDecisions_) {
+            if (cancelled.second == aiPtr) { previous = cancelled.first; }
+          }
           aiDecision_ = std::async(std::launch::async,
-              std::ref(ai), s);
+              [aiPtr, s, controller, stop = aiStopToken_, previous]() {
+                if (previous.valid()) { previous.wait(); }
+
+                // Time the decision, noting who made it and the work done
+                Trace::nameThread("AI");
+                Trace::Scope trace("AI decision", "ai");
+                auto decision = (*aiPtr)(s, stop);
+                if (trace.isActive()) {
+                  trace.setArgs("\"team\":" + std::to_string(s.currentTeam)
+                      + ",\"controller\":\"" + controller
+                      + "\",\"statesProcessed\":" 
+                      + std::to_string(aiPtr->getStatesProcessed())
+                      + ",\"open\":" 
+                      + std::to_string(aiPtr->getOpenStatesRemaining())
+                      + ",\"closed\":" 
+                      + std::to_string(aiPtr->getClosedStates()));
+                }
+                return decision;
+              });
         }
       }
 
@@ -315,6 +447,15 @@ namespace Strategy {
       // Log actions to terminal
       void logAction(const GameState& state, const Action& action);
 
+      // Show controls and histograms for replaying a recorded search
+      void debugSearchReplay(const GameState& state);
+
+      // Start replaying a search, working out what each state had selected
+      void prepareReplay(const Controller::SearchLog<Action>& log);
+
+      // Shade tiles by how often the replayed search expanded their selection
+      void renderReplay(sf::RenderWindow& window, const GameState& state);
+
       // Adjust graphics for current game size
       void resizeGame();
 
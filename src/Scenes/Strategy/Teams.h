@@ -0,0 +1,160 @@
+// Strategy/Teams.h
+// The number of units each team has left, and whether the game is over
+
+#ifndef STRATEGY_TEAMS_H
+#define STRATEGY_TEAMS_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <utility>
+#include <algorithm>
+
+#include "Common.h"
+
+// Seperate Strategy related classes from other games
+namespace Strategy {
+
+  // Enum to measure if the game is over
+  enum GameStatus {
+    InProgress,
+    Won,
+    Tied
+  };
+
+  // Unit counts of every team, in a fixed array indexed by team
+  // - Iterating yields (team, count) for teams with units left in ascending
+  //   order, the same as the std::map of team to count it replaces
+  // - Counts are changed as units are added and removed rather than
+  //   recounted from the board, and copying them never allocates
+  // - Where each team's units are is kept by the map's team layers
+  class Teams {
+
+    public:
+
+      // A participating team, as it would appear in a std::map
+      typedef std::pair<Team, unsigned int> value_type;
+
+      // Iterates teams with units left in ascending order
+      class Iterator {
+        public:
+          Iterator(const Teams& teams, Team team)
+            : teams_(&teams), value_(team, teams.getCount(team)) {}
+          const value_type& operator*() const { return value_; }
+          const value_type* operator->() const { return &value_; }
+          Iterator& operator++() {
+            value_.first = teams_->next(value_.first + 1);
+            value_.second = teams_->getCount(value_.first);
+            return *this;
+          }
+          bool operator==(const Iterator& o) const {
+            return value_.first == o.value_.first;
+          }
+          bool operator!=(const Iterator& o) const {
+            return !(*this == o);
+          }
+        private:
+          const Teams* teams_;
+          value_type value_;
+      };
+
+      // Iterate participating teams
+      Iterator begin() const { return Iterator(*this, next(0)); }
+      Iterator end() const { return Iterator(*this, limit); }
+
+      // Find a team, or end if it has no units left
+      Iterator find(Team team) const {
+        return getCount(team) > 0 ? Iterator(*this, team) : end();
+      }
+
+      // Find the first participating team after the given one
+      Iterator upper_bound(Team team) const {
+        return Iterator(*this, next(team + 1));
+      }
+
+      // Number of teams with units left
+      std::size_t size() const { return participating_; }
+      bool empty() const { return participating_ == 0; }
+
+      // Number of units a team has left
+      unsigned int getCount(Team team) const {
+        return team < limit ? counts_[team] : 0;
+      }
+
+      // Count a unit joining or leaving a team
+      // Teams above maxTeam can't be counted, so maps holding them are
+      // refused when loaded
+      // Removing a unit the team doesn't have means the counts no longer
+      // match the board, so both are checked rather than ignored
+      void addUnit(Team team) {
+        assert(team <= maxTeam);
+        if (counts_[team]++ == 0) { participating_ += 1; }
+      }
+      void removeUnit(Team team) {
+        assert(team <= maxTeam && counts_[team] > 0);
+        if (--counts_[team] == 0) { participating_ -= 1; }
+      }
+
+      // Forget every unit
+      void clear() {
+        counts_.fill(0);
+        participating_ = 0;
+      }
+
+      // Check whether the game is over, and who won if so
+      // Once out of turns, the team with the most units wins
+      std::pair<GameStatus, Team> getStatus(bool isOutOfTurns) const {
+
+        // Find the team with the most units
+        if (isOutOfTurns) {
+          unsigned int mostUnits = 0;
+          unsigned int teamsWithMostUnits = 0;
+          Team winningTeam = Team(0);
+          for (const auto& kvp : *this) {
+            if (kvp.second > mostUnits) {
+              winningTeam = kvp.first;
+              mostUnits = kvp.second;
+              teamsWithMostUnits = 1;
+            }
+            else if (kvp.second == mostUnits) {
+              teamsWithMostUnits += 1;
+            }
+          }
+          return std::make_pair(
+              teamsWithMostUnits == 1 ? GameStatus::Won : GameStatus::Tied,
+              winningTeam);
+        }
+
+        // Otherwise the game is over when at most one team is left
+        if (participating_ == 1) {
+          return std::make_pair(GameStatus::Won, begin()->first);
+        }
+        else if (participating_ == 0) {
+          return std::make_pair(GameStatus::Tied, Team(0));
+        }
+        return std::make_pair(GameStatus::InProgress, Team(0));
+      }
+
+      // Compare the counts of every team
+      bool operator==(const Teams& o) const { return counts_ == o.counts_; }
+      bool operator!=(const Teams& o) const { return !(*this == o); }
+
+    private:
+
+      // One past the highest team
+      static constexpr Team limit = maxTeam + 1;
+
+      // Units left in each team, and the number of teams with any
+      std::array<std::uint16_t, limit> counts_ = {};
+      std::uint16_t participating_ = 0;
+
+      // Find the first participating team at or after the given one
+      Team next(Team team) const {
+        while (team < limit && counts_[team] == 0) { ++team; }
+        return std::min(team, limit);
+      }
+  };
+}
+
+#endif
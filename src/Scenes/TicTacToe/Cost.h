@@ -6,6 +6,8 @@
 
 #include <climits>
 
+#include "../../Controller/Common.h"
+
 // Encapsulate TicTacToe related classes
 namespace TicTacToe {
 
@@ -22,7 +24,12 @@ namespace TicTacToe {
 
   // Combine Costs
   inline Cost operator+ (const Cost& a, const Cost& b) {
-    return Cost{ a.logicPenalty + b.logicPenalty};
+    return Cost{ Controller::saturatingAdd(a.logicPenalty, b.logicPenalty) };
+  }
+
+  // Scale Costs
+  inline Cost operator* (const Cost& a, unsigned int m) {
+    return Cost{ Controller::saturatingMultiply(a.logicPenalty, m) };
   }
 
   // These are BAD penalties
@@ -161,12 +161,12 @@ TicTacToe::Game::addDebugDetails() {
     ImGui::SameLine();
     ImGui::Combo("", 
         reinterpret_cast<int*>(&playerX_), 
-        Controller::typeList, IM_ARRAYSIZE(Controller::typeList));
+        Controller::typeList, Controller::sharedTypeCount);
     ImGui::Text("O Controller: ");
     ImGui::SameLine();
     ImGui::Combo(" ", 
         reinterpret_cast<int*>(&playerO_), 
-        Controller::typeList, IM_ARRAYSIZE(Controller::typeList));
+        Controller::typeList, Controller::sharedTypeCount);
 
     ImGui::Text("Turn: %u (%s)", 
         state.turnNumber,
@@ -498,6 +498,13 @@ TicTacToe::Game::continueGame() {
     return;
   }
 
+  // Beam search needs a strategy case to run
+  else if ((int)controller >= Controller::sharedTypeCount) {
+    Console::log("[Error] %s controller cannot function in tic-tac-toe",
+        Controller::typeToString(controller).c_str());
+    return;
+  }
+
   // If its a random, invoke RandomController::Type::decide
   else if (controller == Controller::Type::Random) {
     attempt = Controller::Random::decide<GameState, Move> (
@@ -0,0 +1,148 @@
+// Trace.cpp
+// Records timed spans and writes them as a Chrome trace for profiling
+
+#include "Trace.h"
+
+#include <fstream>
+#include <utility>
+
+#include "Console.h"
+
+// Most spans held at once, roughly 64MB, before spans are dropped
+static const std::size_t maxEvents = 1 << 20;
+
+// Initialise static members
+std::atomic<bool> Trace::recording_{false};
+std::atomic<unsigned int> Trace::sampleRate_{100};
+Trace::Clock::time_point Trace::origin_;
+std::string Trace::filename_ = "trace.json";
+std::mutex Trace::mutex_;
+std::vector<Trace::Event> Trace::events_;
+std::map<unsigned int, std::string> Trace::threadNames_;
+unsigned long Trace::dropped_ = 0;
+
+// Start timing a span if it should be recorded
+Trace::Scope::Scope(const char* name, const char* category, bool isSampled)
+    : name_(name), category_(category), isActive_(isRecording()) {
+
+  // Only record one in every few sampled spans on each thread
+  if (isActive_ && isSampled) {
+    static thread_local unsigned int calls = 0;
+    isActive_ = ++calls >= sampleRate_.load(std::memory_order_relaxed);
+    if (isActive_) { calls = 0; }
+  }
+  if (isActive_) { start_ = Clock::now(); }
+}
+
+// Record the span if it was timed and recording hasn't stopped
+Trace::Scope::~Scope() {
+  if (!isActive_ || !isRecording()) { return; }
+  const auto end = Clock::now();
+  const auto toMicroseconds = [](const Clock::duration& d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+  };
+  record(Event{name_, category_, getThreadId(),
+      toMicroseconds(start_ - origin_), toMicroseconds(end - start_),
+      std::move(args_)});
+}
+
+// Attach values to the span
+void
+Trace::Scope::setArgs(const std::string& args) {
+  if (isActive_) { args_ = args; }
+}
+
+// Begin recording spans
+void
+Trace::start(const std::string& filename) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.clear();
+    dropped_ = 0;
+    filename_ = filename;
+    origin_ = Clock::now();
+  }
+  recording_ = true;
+  Console::log("Recording trace to %s..", filename.c_str());
+}
+
+// Stop recording and write the trace
+void
+Trace::stop() {
+  if (!recording_.exchange(false)) { return; }
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Write spans as complete events, timed in microseconds
+  std::ofstream file(filename_);
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool isFirst = true;
+  for (const auto& thread : threadNames_) {
+    file << (isFirst ? "" : ",")
+        << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+        << thread.first << ",\"args\":{\"name\":\"" << thread.second << "\"}}";
+    isFirst = false;
+  }
+  for (const auto& event : events_) {
+    file << (isFirst ? "" : ",")
+        << "\n{\"name\":\"" << event.name
+        << "\",\"cat\":\"" << event.category
+        << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+        << ",\"ts\":" << event.start
+        << ",\"dur\":" << event.duration
+        << ",\"args\":{" << event.args << "}}";
+    isFirst = false;
+  }
+  file << "\n]}\n";
+  file.close();
+
+  // Report what was written and free the spans
+  Console::log("Trace written to %s (%zu spans, %lu dropped).",
+      filename_.c_str(), events_.size(), dropped_);
+  std::vector<Event>().swap(events_);
+}
+
+// Start or stop recording
+void
+Trace::toggle() {
+  if (isRecording()) { stop(); }
+  else { start(); }
+}
+
+// Get how many calls pass between recorded sampled spans
+unsigned int
+Trace::getSampleRate() {
+  return sampleRate_;
+}
+
+// Set how many calls pass between recorded sampled spans
+void
+Trace::setSampleRate(unsigned int rate) {
+  sampleRate_ = rate > 0 ? rate : 1;
+}
+
+// Name the calling thread
+void
+Trace::nameThread(const std::string& name) {
+  const unsigned int id = getThreadId();
+  std::lock_guard<std::mutex> lock(mutex_);
+  threadNames_[id] = name;
+}
+
+// Number threads in the order they first record anything
+unsigned int
+Trace::getThreadId() {
+  static std::atomic<unsigned int> next{1};
+  static thread_local const unsigned int id = next++;
+  return id;
+}
+
+// Store a finished span, dropping it if there's no room
+void
+Trace::record(Event&& event) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (events_.size() >= maxEvents) {
+    dropped_ += 1;
+    return;
+  }
+  events_.push_back(std::move(event));
+}
@@ -0,0 +1,110 @@
+// Trace.h
+// Records timed spans and writes them as a Chrome trace for profiling
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+// Static class collecting spans from any thread while recording
+// The output loads into chrome://tracing or ui.perfetto.dev
+class Trace {
+  public:
+
+    // Clock used to time spans
+    typedef std::chrono::steady_clock Clock;
+
+    // Times a span from construction to destruction
+    // Does nothing unless a trace is being recorded
+    class Scope {
+      public:
+
+        // Sampled spans are only recorded once every sample rate times
+        // Use them for functions called too often to record every call
+        Scope(const char* name, const char* category, bool isSampled = false);
+        ~Scope();
+
+        // Scopes are tied to the block they time
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        // Attach values to the span, as the body of a JSON object
+        void setArgs(const std::string& args);
+
+        // Check whether this span will be recorded
+        bool isActive() const { return isActive_; }
+
+      private:
+        const char* name_;
+        const char* category_;
+        bool isActive_;
+        Clock::time_point start_;
+        std::string args_;
+    };
+
+    // Begin recording spans, forgetting any that weren't written
+    static void start(const std::string& filename = "trace.json");
+
+    // Stop recording and write the trace to file
+    static void stop();
+
+    // Start or stop recording
+    static void toggle();
+
+    // Check whether spans are being recorded
+    static bool isRecording() {
+      return recording_.load();
+    }
+
+    // Get/set how many calls pass between recorded sampled spans
+    static unsigned int getSampleRate();
+    static void setSampleRate(unsigned int rate);
+
+    // Name the calling thread in the trace
+    static void nameThread(const std::string& name);
+
+  private:
+
+    // A finished span
+    struct Event {
+      const char* name;
+      const char* category;
+      unsigned int thread;
+      double start;
+      double duration;
+      std::string args;
+    };
+
+    // Whether spans are being recorded
+    static std::atomic<bool> recording_;
+
+    // Calls between recorded sampled spans
+    static std::atomic<unsigned int> sampleRate_;
+
+    // When recording started, which spans are measured from
+    static Clock::time_point origin_;
+
+    // Where the trace is written
+    static std::string filename_;
+
+    // Spans recorded so far, guarded by a mutex
+    static std::mutex mutex_;
+    static std::vector<Event> events_;
+    static std::map<unsigned int, std::string> threadNames_;
+
+    // Number of spans thrown away after running out of room
+    static unsigned long dropped_;
+
+    // Get a small number identifying the calling thread
+    static unsigned int getThreadId();
+
+    // Store a finished span
+    static void record(Event&& event);
+};
+
+#endif
@@ -0,0 +1,38 @@
+// tests/Check.h
+// A minimal way for the tests to report what failed
+
+#ifndef TESTS_CHECK_H
+#define TESTS_CHECK_H
+
+#include <cstdio>
+
+// Seperate test helpers from the game
+namespace Tests {
+
+  // Number of checks that have failed so far
+  inline unsigned int& failures() {
+    static unsigned int count = 0;
+    return count;
+  }
+
+  // Report a failed check along with where it was made
+  inline void check(bool passed, const char* what, const char* file,
+      int line) {
+    if (!passed) {
+      std::printf("%s:%d: check failed: %s\n", file, line, what);
+      failures() += 1;
+    }
+  }
+
+  // Report how the tests went, giving the exit code for main
+  inline int finish(const char* name) {
+    std::printf("%s: %u failure(s)\n", name, failures());
+    return failures() == 0 ? 0 : 1;
+  }
+}
+
+// Check a condition, noting the expression if it doesn't hold
+#define CHECK(condition) \
+  Tests::check((condition), #condition, __FILE__, __LINE__)
+
+#endif
@@ -0,0 +1,97 @@
+// tests/StrategyTests.cpp
+// Checks the strategy game's rules and packed states on the bundled maps
+
+#include "Check.h"
+#include "../src/Scenes/Strategy/Strategy.h"
+#include "../src/Scenes/Strategy/PackedState.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+// Load a bundled map and set up the state a game on it starts with
+std::pair<bool, Strategy::GameState>
+loadStart(const std::string& name) {
+  Strategy::GameState state;
+  std::ifstream file("Assets/Maps/" + name + ".stratmap");
+  std::stringstream contents;
+  contents << file.rdbuf();
+  if (!file || !(contents >> state.map)) {
+    return std::make_pair(false, state);
+  }
+  state.teams = Strategy::Game::countTeams(state.map);
+  state.currentTeam = state.teams.begin()->first;
+  state.remainingMP = state.map.startingMP;
+  state.remainingAP = state.map.startingAP;
+  Strategy::updateStatus(state);
+  return std::make_pair(true, state);
+}
+
+// States reached by random play are packed and unpacked without change
+void
+testPackedCodec(const Strategy::GameState& start, unsigned int actions) {
+  Strategy::PackedCodec codec;
+  CHECK(codec.canEncode(start));
+  if (!codec.canEncode(start)) { return; }
+  codec.prepare(start);
+
+  // Play legal actions chosen by a fixed generator, starting over when the
+  // game ends, and check every state reached
+  std::uint32_t seed = 2024;
+  const auto random = [&seed]() {
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+  };
+  Strategy::GameState state = start;
+  bool isRestored = true, isActionRestored = true;
+  for (unsigned int i = 0; i < actions; ++i) {
+    const auto options = Strategy::Game::getAllPossibleActions(state);
+    if (options.empty()) {
+      state = start;
+      continue;
+    }
+    const auto& action = options[random() % options.size()];
+    const auto decoded = codec.decodeAction(codec.encodeAction(action));
+    isActionRestored = isActionRestored && decoded.tag == action.tag
+        && decoded.location == action.location;
+    const auto attempt = Strategy::Game::takeAction(state, action);
+    if (!attempt.first) { continue; }
+    state = attempt.second;
+    const auto key = codec.encodeState(state);
+    const auto unpacked = codec.decodeState(key);
+    isRestored = isRestored && unpacked == state
+        && unpacked.teams == state.teams
+        && codec.encodeState(unpacked) == key;
+  }
+  CHECK(isRestored);
+  CHECK(isActionRestored);
+}
+
+// Run every test on every bundled map
+int
+main() {
+  const char* maps[] = {"default_5x5", "default_7x7", "cross_wall_5x5",
+      "cross_with_block_7x7", "smile"};
+  for (const char* name : maps) {
+    const auto start = loadStart(name);
+    if (!start.first) { std::printf("Couldn't load map %s\n", name); }
+    CHECK(start.first);
+    if (!start.first) { continue; }
+
+    // Applying then undoing actions agrees with takeAction
+    for (unsigned int round = 0; round < 20; ++round) {
+      const auto checked = Strategy::Game::checkApplyAndUndo(
+          start.second, 500);
+      if (!checked.first) {
+        std::printf("%s: apply and undo disagreed after %u actions\n",
+            name, checked.second);
+      }
+      CHECK(checked.first);
+    }
+    testPackedCodec(start.second, 2000);
+  }
+  return Tests::finish("StrategyTests");
+}
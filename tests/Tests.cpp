@@ -0,0 +1,311 @@
+// tests/Tests.cpp
+// Checks the search structures that only need the standard library
+
+#include "Check.h"
+#include "../src/Controller/AStar/OpenList.h"
+#include "../src/Controller/AStar/NodeArena.h"
+#include "../src/Controller/AStar/SearchLog.h"
+#include "../src/Scenes/Strategy/Bitboard.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+// Keys leave the heap by lowest f, then in the order they were pushed
+template <unsigned int D>
+void
+testIndexedHeap() {
+  const std::less<int> less;
+  Controller::OpenList::IndexedHeap<unsigned int, int, D> heap;
+
+  // Push keys with many equal f values, expecting them back sorted
+  std::vector<std::pair<int, unsigned int>> expected;
+  for (unsigned int key = 0; key < 200; ++key) {
+    const int f = (int)(key * 37 % 50);
+    heap.push(key, f, less);
+    expected.emplace_back(f, key);
+  }
+  std::sort(expected.begin(), expected.end());
+  CHECK(heap.size() == 200);
+  bool isOrdered = true;
+  for (const auto& entry : expected) {
+    isOrdered = isOrdered && heap.top(less) == entry.second;
+    heap.pop(less);
+  }
+  CHECK(isOrdered);
+  CHECK(heap.empty());
+
+  // Updating a key moves it without changing its age
+  heap.push(0, 10, less);
+  heap.push(1, 20, less);
+  heap.push(2, 30, less);
+  heap.update(2, 5, less);
+  CHECK(heap.top(less) == 2);
+  heap.update(2, 10, less);
+  CHECK(heap.top(less) == 0);
+  CHECK(heap.age(2) > heap.age(0));
+
+  // Erasing a key from the middle leaves the rest in order
+  heap.erase(0, less);
+  CHECK(!heap.contains(0));
+  CHECK(heap.top(less) == 2);
+  heap.pop(less);
+  CHECK(heap.top(less) == 1);
+  CHECK(heap.priority(1) == 20);
+}
+
+// The key with the lowest h is chosen from those within the bound
+void
+testFocalList() {
+  const std::less<int> less;
+  Controller::OpenList::FocalList<unsigned int, int> focal;
+  focal.setBound(3, 2);
+
+  // Only keys with f up to 15 are in bounds of the lowest f, 10
+  focal.push(0, 10, 9, less);
+  focal.push(1, 14, 1, less);
+  focal.push(2, 16, 0, less);
+  CHECK(focal.size() == 3);
+  CHECK(focal.top(less) == 1);
+  focal.pop(less);
+  CHECK(focal.top(less) == 0);
+  focal.pop(less);
+
+  // Once the lowest f rises, keys outside the bound are taken back in
+  CHECK(focal.top(less) == 2);
+
+  // Updating a key can move it out of bounds
+  focal.push(3, 17, 5, less);
+  focal.update(2, 30, 0, less);
+  CHECK(focal.top(less) == 3);
+  focal.pop(less);
+  CHECK(focal.top(less) == 2);
+  focal.pop(less);
+  CHECK(focal.empty());
+
+  // Ties in h go to the oldest key
+  focal.setBound(1, 1);
+  focal.push(4, 10, 3, less);
+  focal.push(5, 10, 3, less);
+  CHECK(focal.top(less) == 4);
+}
+
+// Gives every state the same hash, so lookups rely on operator==
+struct CollidingHash {
+  std::size_t operator()(int) const { return 7; }
+};
+
+// States are given dense ids and found again by value
+void
+testNodeArena() {
+
+  // With a normal hash, enough states to make the table grow
+  Controller::NodeArena<int, char, int> arena;
+  CHECK(arena.find(1) == Controller::invalidNode);
+  bool isDense = true;
+  for (int i = 0; i < 5000; ++i) {
+    const auto inserted = arena.insert(i * 3);
+    isDense = isDense && inserted.second && inserted.first == (unsigned)i;
+  }
+  CHECK(isDense);
+  CHECK(arena.size() == 5000);
+  bool isFound = true;
+  for (int i = 0; i < 5000; ++i) {
+    const auto id = arena.find(i * 3);
+    isFound = isFound && id == (unsigned)i && arena.getState(id) == i * 3;
+  }
+  CHECK(isFound);
+  CHECK(arena.find(1) == Controller::invalidNode);
+  const auto again = arena.insert(300);
+  CHECK(!again.second && again.first == 100);
+
+  // Closing is only counted once per node
+  arena.close(4);
+  arena.close(4);
+  CHECK(arena.getClosedCount() == 1);
+  arena.reopen(4);
+  CHECK(arena.getClosedCount() == 0);
+
+  // Clearing forgets states
+  arena.clear();
+  CHECK(arena.size() == 0);
+  CHECK(arena.find(0) == Controller::invalidNode);
+
+  // With every hash the same, states are still told apart
+  Controller::NodeArena<int, char, int, CollidingHash> colliding;
+  for (int i = 0; i < 50; ++i) { colliding.insert(i); }
+  bool isApart = true;
+  for (int i = 0; i < 50; ++i) {
+    isApart = isApart && colliding.find(i) == (unsigned)i;
+  }
+  CHECK(isApart);
+  CHECK(colliding.find(50) == Controller::invalidNode);
+  CHECK(colliding.getCollisions() > 0);
+}
+
+// Write and read actions as plain ints, refusing negative ones
+void
+writeInt(std::ostream& out, const int& action) {
+  out.write(reinterpret_cast<const char*>(&action), sizeof(action));
+}
+bool
+readInt(std::istream& in, int& action) {
+  return in.read(reinterpret_cast<char*>(&action), sizeof(action))
+      && action >= 0;
+}
+
+// Load a log from bytes, returning whether it was accepted
+bool
+loadLog(Controller::SearchLog<int>& log, const std::string& bytes) {
+  std::istringstream in(bytes);
+  return log.load(in, readInt);
+}
+
+// Logs survive a round trip, and damaged ones are refused
+void
+testSearchLog() {
+  typedef Controller::SearchLog<int> Log;
+
+  // Build and save a small log
+  Log log;
+  log.setContext("map");
+  log.record(Log::Entry{0, Controller::invalidNode, 0, 0, 0.f, 4.f, false});
+  log.record(Log::Entry{1, 0, 1, 7, 1.f, 3.f, false});
+  log.record(Log::Entry{2, 1, 2, 9, 2.f, 0.f, true});
+  std::ostringstream out;
+  log.save(out, writeInt);
+  const std::string bytes = out.str();
+
+  // Load it back
+  Log loaded;
+  CHECK(loadLog(loaded, bytes));
+  CHECK(loaded.getContext() == "map");
+  CHECK(loaded.size() == 3);
+  if (loaded.size() == 3) {
+    const auto& last = loaded.getEntries()[2];
+    CHECK(last.node == 2 && last.parent == 1 && last.depth == 2);
+    CHECK(last.action == 9 && last.g == 2.f && last.isEndpoint);
+  }
+
+  // Offsets of fields in the saved bytes
+  const std::size_t contextSizeAt = 8;
+  const std::size_t countAt = 16 + 3;
+  const std::size_t firstDepthAt = countAt + 8 + 8;
+  const std::size_t entrySize = 3 * 4 + 4 + 2 * 4 + 1;
+
+  // Overwrite a value in a copy of the saved bytes
+  const auto patch = [&bytes](std::size_t at, auto value) {
+    std::string damaged = bytes;
+    damaged.replace(at, sizeof(value),
+        reinterpret_cast<const char*>(&value), sizeof(value));
+    return damaged;
+  };
+
+  // Every kind of damage is refused, leaving the log empty
+  const std::vector<std::pair<const char*, std::string>> damaged = {
+    {"empty", ""},
+    {"bad magic", patch(0, std::uint32_t(0))},
+    {"bad version", patch(4, std::uint32_t(99))},
+    {"huge context", patch(contextSizeAt, std::uint64_t(1) << 40)},
+    {"huge count", patch(countAt, std::uint64_t(1) << 40)},
+    {"count past the end", patch(countAt, std::uint64_t(4))},
+    {"depth past the count", patch(firstDepthAt, std::uint32_t(3))},
+    {"bad action", patch(firstDepthAt + 4, std::int32_t(-1))},
+    {"bad endpoint", patch(firstDepthAt + 4 + 4 + 8, std::uint8_t(2))},
+    {"truncated", bytes.substr(0, bytes.size() - 1)},
+    {"missing entry", bytes.substr(0, bytes.size() - entrySize)}
+  };
+  for (const auto& d : damaged) {
+    Log refused = loaded;
+    const bool isLoaded = loadLog(refused, d.second);
+    if (isLoaded || !refused.empty() || !refused.getContext().empty()) {
+      std::printf("SearchLog accepted a log with %s\n", d.first);
+    }
+    CHECK(!isLoaded && refused.empty());
+  }
+}
+
+// Boards agree with a plain vector of bools, across inline and heap words
+void
+testBitboard() {
+  const std::size_t tiles = 400;
+  Strategy::Bitboard a, b;
+  std::vector<bool> expectedA(tiles), expectedB(tiles);
+
+  // Set and reset tiles chosen by a fixed generator
+  std::uint32_t seed = 12345;
+  const auto random = [&seed]() {
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+  };
+  for (int i = 0; i < 2000; ++i) {
+    const std::size_t tile = random() % tiles;
+    const bool isA = random() & 1, isSet = random() % 3 != 0;
+    Strategy::Bitboard& board = isA ? a : b;
+    std::vector<bool>& expected = isA ? expectedA : expectedB;
+    if (isSet) { board.set(tile); } else { board.reset(tile); }
+    expected[tile] = isSet;
+  }
+
+  // Compare a board with what's expected of it
+  const auto matches = [tiles](const Strategy::Bitboard& board,
+      const std::vector<bool>& expected) {
+    std::vector<std::size_t> visited;
+    board.forEach([&visited](std::size_t i) { visited.push_back(i); });
+    std::vector<std::size_t> walked;
+    for (std::size_t i = board.next(0); i != Strategy::Bitboard::npos;
+        i = board.next(i + 1)) {
+      walked.push_back(i);
+    }
+    std::vector<std::size_t> wanted;
+    for (std::size_t i = 0; i < tiles; ++i) {
+      if (expected[i]) { wanted.push_back(i); }
+      if (board.test(i) != expected[i]) { return false; }
+    }
+    return visited == wanted && walked == wanted
+        && board.count() == wanted.size() && board.any() == !wanted.empty();
+  };
+  CHECK(matches(a, expectedA));
+  CHECK(matches(b, expectedB));
+
+  // Combine the boards
+  std::vector<bool> both(tiles), either(tiles), onlyA(tiles);
+  bool isShared = false;
+  for (std::size_t i = 0; i < tiles; ++i) {
+    both[i] = expectedA[i] && expectedB[i];
+    either[i] = expectedA[i] || expectedB[i];
+    onlyA[i] = expectedA[i] && !expectedB[i];
+    isShared = isShared || both[i];
+  }
+  CHECK(matches(a & b, both));
+  CHECK(matches(a | b, either));
+  CHECK(matches(Strategy::Bitboard(a).remove(b), onlyA));
+  CHECK(a.intersects(b) == isShared);
+
+  // Boards of different sizes are equal when they hold the same tiles
+  Strategy::Bitboard small, large;
+  small.set(3);
+  large.set(3);
+  large.set(300);
+  CHECK(small != large);
+  large.reset(300);
+  CHECK(small == large);
+  CHECK(large.next(4) == Strategy::Bitboard::npos);
+  CHECK(!Strategy::Bitboard().any());
+}
+
+// Run every test
+int
+main() {
+  testIndexedHeap<2>();
+  testIndexedHeap<4>();
+  testFocalList();
+  testNodeArena();
+  testSearchLog();
+  testBitboard();
+  return Tests::finish("Tests");
+}